@@ -2,49 +2,271 @@
  * Author : Prahar Ijner
  * This file contains the CPU class. It is used to simulate a virtual single processor CPU.
  *
- * Requires PCB.h, stats.H
+ * The whole state of a simulation (clock, jobs in memory, queues, IO devices, statistics and the position in the job
+ * queue) can be saved to a snapshot file and restored later, to continue a long simulation from where it stopped.
+ *
+ * The CPU counts its busy time, context switches, preemptions and admissions as it runs, and a Sampler can be attached
+ * to record them with the queue lengths at regular intervals (look at Sampler.h). Both engines take the same samples.
+ * A TraceWriter can be attached to write every CPU shot, IO operation and preemption as a trace (look at TraceWriter.h).
+ *
+ * Context switches, dispatches, admissions and IO system calls can be given a cost in CPU time (look at Overhead.h).
+ * Overhead is paid before the next job runs: the clock and IO devices advance, but no job does, and the time is
+ * counted separately from the busy time.
+ *
+ * Requires PCB.h, stats.H, ReadyQueue.h, JobSource.h, ResultsWriter.h, IOSubsystem.h, Snapshot.h, Sampler.h, TraceWriter.h,
+ *          SPSCRing.h, Overhead.h
  */
 
 #ifndef CPU_H_INCLUDED
 #define CPU_H_INCLUDED
 
 #include "PCB.h"
+#include "ReadyQueue.h"
+#include "JobSource.h"
+#include "ResultsWriter.h"
+#include "IOSubsystem.h"
+#include "Sampler.h"
+#include "TraceWriter.h"
+#include "Overhead.h"
+#include "SPSCRing.h"
 #include <queue>
 #include <algorithm>
+#include <climits>
 
 #define MAX_JOBS 10
+#define PRINT_INTERVAL 200
+#define PRIORITY_LEVELS 4
+#define REPORT_BATCH 256        // Reports passed to the reporter thread at a time
+
+#define REPORT_JOB 0            // A job completed
+#define REPORT_STATE 1          // The state of the CPU was printed
+
+// Something the CPU reports while a pipeline runs it, for the reporter thread to print or record (look at Pipeline.h)
+struct reportRecord{
+    int kind;                   // REPORT_JOB or REPORT_STATE
+    jobResult job;              // The job completed
+    long ready, blocked, completed;     // The state of the CPU
+};
+
+void printState(long ready, long blocked, long completed);
 
 class CPU{
 private:
-    unsigned long CPUTime;
-    int jobsInMemory, totalWait, quantum, jobsComplete;
-    queue<PCB> readyQ, IOBlockeQ;
+    unsigned long CPUTime, events;
+    int jobsInMemory, maxJobs, quantum, jobsComplete, priorityLevels;
+    long agingInterval;
+    bool verbose;
+    ResultsWriter *results;     // Where the row of every completed job is recorded (NULL if it isn't)
+    vector<jobResult> *completions;     // Where the results of every completed job are collected (NULL if they aren't)
+    bool admitOnArrival;        // Are jobs only admitted once the clock reaches their arrival time?
+    bool hasPending;
+    jobRecord pending;          // Next job of the job queue, read but not admitted yet because it hasn't arrived
+    vector<int> pendingBursts;  // Bursts of the pending job when it was restored from a snapshot
+    unsigned long stopTime;     // The simulation stops when the clock reaches this time
+    unsigned long busyTime, contextSwitches, preemptions, admissions;
+    int lastRun;                // Slot of the job that ran last (-1 if none or it completed)
+    Sampler *sampler;           // Where the state of the CPU is recorded at regular intervals (NULL if it isn't)
+    unsigned long nextSample;   // Time of the next sample (ULONG_MAX if there is no sampler)
+    void takeSample();
+    void countDispatch();
+    TraceWriter *trace;         // Where every shot, IO operation and preemption is written (NULL if they aren't)
+    bool shotOpen;              // Is the job at the front of the ready queue in the middle of a shot?
+    unsigned long shotStart;    // Time the current shot started
+    void endShot(int slot);
+    Overhead overhead;          // Cost in CPU time of context switches, dispatches, admissions and IO system calls (check Overhead.h)
+    unsigned long overheadLeft; // Overhead charged and not paid yet. It is paid before any job runs again
+    unsigned long overheadEvents[OVERHEAD_KINDS], overheadTime[OVERHEAD_KINDS];    // Events and time charged for each kind of overhead
+    bool payingOverhead;        // Has the CPU started paying the overhead it owes?
+    unsigned long overheadStart;    // Time it started
+    void charge(int kind);
+    void beginOverhead();
+    void endOverhead();
+    void advanceClock(unsigned long endTime, bool printState, bool stopOnReady, bool busy);
+    SPSCRing<reportRecord> *reports;    // Where completed jobs and CPU states go instead of being printed or recorded (NULL if they don't)
+    vector<reportRecord> reportBatch;   // Reports not passed on yet
+    void report(const reportRecord &r);
+    unsigned long nextStop();
+    PCBPool jobTable;           // PCBs of the jobs in memory. The queues hold indices (slots) into this pool
+    ReadyQueue readyQ;
+    IOSubsystem IOBlockeQ;      // Jobs blocked for IO (check IOSubsystem.h)
+    long readyKey(int slot);
 public:
-    CPU(){
-        // Default class constructor
+    CPU(int memory = MAX_JOBS, int io = IO_TIME){
+        // Default class constructor (memory is the number of jobs that fit in memory at a time, io the time an IO operation takes on the one IO device)
         CPUTime = 0;
+        events = 0;
         jobsInMemory = 0;
-        totalWait = 0;
+        maxJobs = memory;
+        IOBlockeQ.configure(vector<long>(1, io));
         jobsComplete = 0;
+        verbose = true;
+        results = NULL;
+        completions = NULL;
+        admitOnArrival = false;
+        hasPending = false;
+        stopTime = ULONG_MAX;
+        priorityLevels = 1;
+        agingInterval = 1;
+        busyTime = 0;
+        contextSwitches = 0;
+        preemptions = 0;
+        admissions = 0;
+        lastRun = -1;
+        sampler = NULL;
+        nextSample = ULONG_MAX;
+        trace = NULL;
+        shotOpen = false;
+        shotStart = 0;
+        reports = NULL;
+        overheadLeft = 0;
+        for(int k=0; k<OVERHEAD_KINDS; k++)
+            overheadEvents[k] = overheadTime[k] = 0;
+        payingOverhead = false;
+        overheadStart = 0;
+        jobTable.reserve(max(memory, 0));
     }
     unsigned long getCPUTime()  { return CPUTime; }         // Read the CPU time
+    unsigned long getEvents()   { return events; }          // Read the number of events so far (admissions, burst completions, preemptions, IO completions)
     int  memoryUsed()           { return jobsInMemory; }    // Return the number of jobs in memory
+    int  jobsCompleted()        { return jobsComplete; }    // Return the number of jobs completed
+    void setVerbose(bool v)     { verbose = v; }            // Choose whether completed jobs and CPU states are printed
+    bool isVerbose()            { return verbose; }         // Are completed jobs and CPU states printed?
+    void setResults(ResultsWriter *w)   { results = w; }    // Record the row of every completed job with a results writer (NULL to stop)
+    ResultsWriter *getResults() { return results; }        // Get the results writer completed jobs are recorded with (NULL if none)
+    void setCompletions(vector<jobResult> *c)   { completions = c; }    // Collect the results of every completed job, in the order they complete (NULL to stop)
+    void setReports(SPSCRing<reportRecord> *r)  { reports = r; }    // Pass completed jobs and CPU states to a reporter thread through a ring (NULL to stop)
+    void flushReports();
+    void setAdmitOnArrival(bool a)      { admitOnArrival = a; } // Choose whether jobs are only admitted once they have arrived
+    void setStopTime(unsigned long t)   { stopTime = t; }   // Stop the simulation when the clock reaches this time
+    bool stopped()              { return CPUTime >= stopTime; }     // Has the clock reached the stop time?
+    void setSampler(Sampler *s);
+    void setTrace(TraceWriter *t)       { trace = t; }      // Write every shot, IO operation and preemption with a trace writer (NULL to stop)
+    unsigned long getBusyTime()         { return busyTime; }        // Read the time the CPU spent running jobs
+    unsigned long getContextSwitches()  { return contextSwitches; } // Read the number of times a job other than the one that ran last was dispatched
+    unsigned long getPreemptions()      { return preemptions; }     // Read the number of jobs preempted
+    Overhead &getOverhead()     { return overhead; }        // Get the overhead costs (e.g. to set them before simulation)
+    unsigned long getOverheadTime();
+    bool owesOverhead()         { return overheadLeft > 0; }    // Does the CPU have overhead to pay before a job can run?
+    bool dispatch()             { countDispatch(); return overheadLeft > 0; }   // Give the CPU to the first job in the ready queue. Returns true if that costs overhead to pay first
+    void payOverhead();
+    void payOverheadFor(bool printState);
+    void printOverheadStats();
+    bool pendingJob()           { return hasPending; }      // Has a job been read from the job queue that hasn't arrived yet?
     int  readyJobs()            { return readyQ.size(); }   // Return the number of jobs in ready queue
+    IOSubsystem &getIO()        { return IOBlockeQ; }       // Get the IO devices (e.g. to set the number of devices before simulation)
     int  getQuantum()           { return quantum; }         // Read the value of time quantum set for this CPU
-    PCB  getCurrentJob()        { return readyQ.front(); }  // Get the job that is being or will begin executing
+    PCB  getCurrentJob()        { return jobTable.get(readyQ.front()); }    // Get the job that is being or will begin executing
+    void setReadyOrder(int o);
+    long nextReadyKey()         { return readyQ.nextKey(); }    // Read the smallest key of the ready jobs behind the current job
+    bool setPriorities(int levels, long aging);
+    long priorityKey(PCB job, unsigned long t)  { return basePriority(job)*agingInterval + t; }   // Key of a job of this priority entering the ready queue at time t
+    int  basePriority(PCB job)  { return (job.getID() % priorityLevels + priorityLevels) % priorityLevels; }  // Priority of a job, from 0 (highest) to levels-1
     bool writeQuantum(int q);
     void incCPUTime();
-    bool insertToReady(queue<string> *jobQ);
-    void insertToIOBlock(PCB jobToInsert);
+    bool insertToReady(JobSource *jobQ);
+    void insertToIOBlock();
     void serviceJob();
-    void startJob();
+    void serviceJobFor(int cycles, bool printState, bool stopOnReady = false);
+    void idleUntilEvent();
     stats completeJob();
-    bool sortReadyQ();
     void preemptJob();
     void printCPUState();
+    bool saveSnapshot(string filename, stats &myStats, JobSource &jobQ);
+    bool loadSnapshot(string filename, stats &myStats, JobSource &jobQ);
 
 };
 
+/* Function to record the state of the CPU with a sampler every interval of the sampler from now on (NULL to stop)
+ * Samples are taken at multiples of the interval, so a run resumed from a snapshot continues the same time series
+ */
+void CPU::setSampler(Sampler *s){
+    sampler = s;
+    nextSample = s ? (CPUTime/s->getInterval() + 1)*s->getInterval() : ULONG_MAX;
+}
+
+// Function to record the state of the CPU now with the sampler
+void CPU::takeSample(){
+    struct sample s = { CPUTime, readyQ.size(), IOBlockeQ.size(), jobsInMemory, busyTime, contextSwitches, preemptions,
+                        admissions, (unsigned long)jobsComplete };
+    sampler->add(s);
+    nextSample += sampler->getInterval();
+}
+
+// Function to count a context switch if the job about to run is not the one that ran last, and note when its shot starts
+inline void CPU::countDispatch(){
+    int slot = readyQ.front();
+    if(slot != lastRun){
+        contextSwitches++;
+        lastRun = slot;
+        charge(OVERHEAD_SWITCH);
+    }
+    if(!shotOpen){
+        shotOpen = true;
+        shotStart = CPUTime;
+        charge(OVERHEAD_DISPATCH);
+    }
+}
+
+// Function to charge the cost of an event of a kind of overhead, to be paid before a job runs again
+inline void CPU::charge(int kind){
+    if(!overhead.any())
+        return;
+    long cost = overhead.cost(kind);
+    overheadLeft += cost;
+    overheadEvents[kind]++;
+    overheadTime[kind] += cost;
+}
+
+// Function to note when the CPU starts paying overhead. A shot in progress is written to the trace up to now
+void CPU::beginOverhead(){
+    if(payingOverhead)
+        return;
+    payingOverhead = true;
+    overheadStart = CPUTime;
+    if(shotOpen && trace && shotStart < CPUTime)
+        trace->shot(jobTable.get(readyQ.front()).getID(), shotStart, CPUTime);
+}
+
+// Function to note that the CPU has paid all the overhead it owes, and write it to the trace. A shot in progress continues from now
+void CPU::endOverhead(){
+    payingOverhead = false;
+    if(trace)
+        trace->overhead(overheadStart, CPUTime);
+    if(shotOpen)
+        shotStart = CPUTime;
+}
+
+// Function to end the shot of the job in a slot (when it blocks, is preempted or completes) and write it to the trace
+inline void CPU::endShot(int slot){
+    if(shotOpen && trace)
+        trace->shot(jobTable.get(slot).getID(), shotStart, CPUTime);
+    shotOpen = false;
+}
+
+/* Function to choose the order jobs are picked from the ready queue (look at ReadyQueue.h)
+ * Jobs already in the queue (e.g. restored from a snapshot taken with another policy) are inserted again in the new order
+ */
+void CPU::setReadyOrder(int o){
+    if(o == readyQ.getOrder())
+        return;
+    vector<int> slots = readyQ.drain();
+    readyQ.setOrder(o);
+    for(size_t i=0; i<slots.size(); i++)
+        readyQ.push(slots[i], readyKey(slots[i]));
+}
+
+/* Function to set up priority scheduling (used by ORDER_PRIORITY)
+ * Every job gets a priority from its ID (ID mod levels, 0 is the highest). A job waiting in the ready queue is treated as
+ * one level higher for every aging units of time it has waited, so no job waits forever
+ */
+bool CPU::setPriorities(int levels, long aging){
+    if(levels <= 0 || aging <= 0)
+        return false;
+    priorityLevels = levels;
+    agingInterval = aging;
+    return true;
+}
+
 // Function to store value of time quantum for preemption of jobs
 bool CPU::writeQuantum(int q){
     if(q<=0)            // Can't have non-positive time quantum
@@ -54,152 +276,374 @@ bool CPU::writeQuantum(int q){
 }
 
 /* Function to add a job from job queue to the ready queue is possible
+ * If jobs are admitted on arrival, a job that hasn't arrived yet waits outside memory until the clock reaches its arrival time
  * Returns false if job can't be added to the queue
  */
-bool CPU::insertToReady(queue<string> *jobQ){
-    // If memory is full or there are no more jobs in the job queue, return false
-    if( jobsInMemory == MAX_JOBS || !jobQ->size() )
-        return false;
-
-    // Read the first line of the job queue and remove it from there as it is being added to the ready queue
-    istringstream thisLine(jobQ->front());
-    jobQ->pop();
-
-    // Read job id, time of arrival into the system, and number of bursts
-    int id, arrivalTime, numBursts;
-    thisLine >> id >> arrivalTime >> numBursts;
-
-    // Vector holding all the CPU bursts this process will need to complete execution
-    vector<int> bursts;
-    for(int i=0; i<numBursts; i++){
-        int thisBurst;
-        thisLine >> thisBurst;
-        bursts.push_back(thisBurst);
+bool CPU::insertToReady(JobSource *jobQ){
+    // Read the next job (job id, time of arrival into the system, and the CPU bursts it needs) from the job queue
+    jobRecord job = jobRecord();
+    if(admitOnArrival){
+        if(jobsInMemory == maxJobs)
+            return false;
+        if(!hasPending && !(hasPending = jobQ->next(pending)))
+            return false;
+        if(pending.arrivalTime > (long)CPUTime)
+            return false;
+        job = pending;
+        hasPending = false;
+    }
+    else{
+        // If memory is full or there are no more jobs in the job queue, return false
+        if( jobsInMemory == maxJobs || (!hasPending && jobQ->done()) )
+            return false;
+        if(hasPending){         // A job read before a snapshot was taken is admitted first
+            job = pending;
+            hasPending = false;
+        }
+        else if(!jobQ->next(job))   // A malformed job ends the job queue
+            return false;
     }
 
-    // Create a PCB (defined in PCB.h) for the job just read from the job queue
-    PCB job(id, arrivalTime, numBursts, bursts);
+    // Load the job just read from the job queue into the PCB pool (defined in PCB.h)
+    int slot = jobTable.load(job.id, job.arrivalTime, job.numBursts, job.bursts);
     // Add this new job to the ready queue and increment number of jobs in memory
-    readyQ.push(job);
+    readyQ.push(slot, readyKey(slot));
     jobsInMemory++;
+    admissions++;
+    events++;
+    charge(OVERHEAD_ADMIT);
 
     return true;
 }
 
-/* Function to increment CPU time by 1. It also checks if any job in the IO blocked queue has finished IO
- * and brings it back to the ready queue if it has
+/* Function to increment CPU time by 1. It also checks if any jobs in the IO blocked queue have finished IO
+ * and brings them back to the ready queue if they have
  */
 void CPU::incCPUTime(){
-    // If there's anything in the IO queue, did it just complete IO?
-    if(IOBlockeQ.size()){
-        PCB j = IOBlockeQ.front();
-        if(j.getIOCompTime() == CPUTime){
-            // If it completed IO, set it's state to ready and move it to the ready queue
-            j.setState(STATE_READY);
-            readyQ.push(j);
-            IOBlockeQ.pop();
-        }
+    // Did anything in the IO queue just complete IO?
+    while(IOBlockeQ.nextCompletion() <= CPUTime){
+        // If it completed IO, set it's state to ready and move it to the ready queue
+        int slot = IOBlockeQ.complete();
+        jobTable.get(slot).setState(STATE_READY);
+        readyQ.push(slot, readyKey(slot));
+        events++;
     }
     // Increment CPU time
     CPUTime++;
+    if(CPUTime == nextSample)
+        takeSample();
 }
 
-/* Function to insert a job into the IO Blocked queue
- * It checks if there are any jobs in the IO Blocked queue and accordingly decides when this process will finish IO
- * NOTE : Only one job can perform IO at a given time
+/* Function to move the first job in the ready queue into the IO Blocked queue
+ * The job is queued on the IO device that is free first, and performs IO once the jobs queued before it are done
  */
-void CPU::insertToIOBlock(PCB jobToInsert){
+void CPU::insertToIOBlock(){
+    int slot = readyQ.front();
+    PCB jobToInsert = jobTable.get(slot);
     // process enters into IO only after burst is complete. So signal that first
     jobToInsert.burstComplete();
 
-    // If there are any jobs in the IO Queue, the job being queued has to wait for those to finish IO before it can perform IO
-    if(IOBlockeQ.size()){
-        PCB j = IOBlockeQ.front();
-        // Total waiting time for IO = time for all jobs in IO queue to finish IO
-        int IOwaitTime = (j.getIOCompTime() - CPUTime) + (IOBlockeQ.size() - 1)*IO_TIME;
-        totalWait += IOwaitTime;
-        jobToInsert.setIOCompTime(CPUTime + IOwaitTime + IO_TIME);
-    }
-    // If there are no jobs in IO queue, this job can right away perform IO
-    else
-        jobToInsert.setIOCompTime(CPUTime + IO_TIME);
+    endShot(slot);
+
+    long serviceTime;
+    int device;
+    jobToInsert.setIOCompTime(IOBlockeQ.submit(slot, CPUTime, serviceTime, &device));
+    jobToInsert.addIOTime(serviceTime);
+    if(trace)
+        trace->io(jobToInsert.getID(), device, jobToInsert.getIOCompTime() - serviceTime, jobToInsert.getIOCompTime());
 
     // Insert into the IO Blocked queue and remove from the ready queue
     jobToInsert.setState(STATE_IOB);
-    IOBlockeQ.push(jobToInsert);
     readyQ.pop();
+    events++;
+    charge(OVERHEAD_IO);
 }
 
 // Function to run the first job in the ready queue for 1 unit of time
 void CPU::serviceJob(){
-    PCB *currentJob = &(readyQ.front());
-    currentJob->setState(STATE_RUN);
-    currentJob->incCurrentBurstPC();
+    PCB currentJob = getCurrentJob();
+    if(currentJob.getStartTime() < 0)       // Is this the first CPU cycle the job receives?
+        currentJob.setStartTime(CPUTime);
+    currentJob.setState(STATE_RUN);
+    currentJob.incCurrentBurstPC();
+    busyTime++;
+}
+
+/* Function to run the first job in the ready queue for several units of time in one step (used by the event driven engine)
+ * The clock jumps straight to the next tick at which something observable happens (an IO completion, a state print or a sample),
+ * so the result is identical to calling serviceJob() and incCPUTime() once per unit of time. The step ends early if a job
+ * arrives or the stop time is reached before the end, so the job can be admitted at the same tick as with the tick engine
+ * If stopOnReady is true, the step also ends as soon as a job enters the ready queue (for policies that preempt in favour of it)
+ */
+void CPU::serviceJobFor(int cycles, bool printState, bool stopOnReady){
+    unsigned long startTime = CPUTime;
+    PCB currentJob = getCurrentJob();
+    if(currentJob.getStartTime() < 0)
+        currentJob.setStartTime(CPUTime);
+    currentJob.setState(STATE_RUN);
+
+    advanceClock(min(CPUTime + cycles, max(nextStop(), CPUTime + 1)), printState, stopOnReady, true);
+    currentJob.incCurrentBurstPC(CPUTime - startTime);
+}
+
+// Function to spend 1 unit of time on the overhead the CPU owes
+void CPU::payOverhead(){
+    beginOverhead();
+    overheadLeft--;
+    incCPUTime();
+    if(!overheadLeft)
+        endOverhead();
 }
 
-// Function to initialize start time of a job if it is being run for the first time
-void CPU::startJob(){
-    PCB *currentJob = &(readyQ.front());
-    currentJob->setStartTime(CPUTime);
-    currentJob->setState(STATE_RUN);
+/* Function to spend the overhead the CPU owes in one step (used by the event driven engine)
+ * As with serviceJobFor(), the step ends early if a job arrives or the stop time is reached before the end
+ */
+void CPU::payOverheadFor(bool printState){
+    unsigned long startTime = CPUTime;
+    beginOverhead();
+    advanceClock(min(CPUTime + overheadLeft, max(nextStop(), CPUTime + 1)), printState, false, false);
+    overheadLeft -= CPUTime - startTime;
+    if(!overheadLeft)
+        endOverhead();
+}
+
+/* Function to advance the clock to endTime, jumping straight from one tick at which something observable happens (an IO
+ * completion, a state print or a sample) to the next, so the result is identical to calling incCPUTime() once per unit of time
+ * The time is counted as busy time if busy. If stopOnReady is true, the clock stops as soon as a job enters the ready queue
+ */
+void CPU::advanceClock(unsigned long endTime, bool printState, bool stopOnReady, bool busy){
+    int ready = readyQ.size();
+    while(CPUTime < endTime){
+        // Last tick of this step is the end of the burst, unless an IO completion or a state print comes first
+        unsigned long nextTick = endTime - 1;
+        nextTick = min(nextTick, IOBlockeQ.nextCompletion());
+        if(printState){
+            unsigned long nextPrint = (CPUTime/PRINT_INTERVAL + 1)*PRINT_INTERVAL;
+            if(nextPrint - 1 < nextTick)
+                nextTick = nextPrint - 1;
+        }
+        nextTick = min(nextTick, nextSample - 1);
+
+        if(busy)
+            busyTime += nextTick + 1 - CPUTime;
+        CPUTime = nextTick;
+        incCPUTime();
+        if(printState && CPUTime%PRINT_INTERVAL == 0)
+            printCPUState();
+        if(stopOnReady && readyQ.size() > ready)
+            break;
+    }
+}
+
+/* Function to let the CPU sit idle until the first job in the IO blocked queue finishes IO, the next sample is due, the
+ * next job arrives or the stop time is reached, whichever comes first (used by the event driven engine)
+ * An arrival at the same time as an IO completion comes first, as with the tick engine
+ */
+void CPU::idleUntilEvent(){
+    unsigned long stop = nextStop();
+    unsigned long next = min(IOBlockeQ.nextCompletion(), nextSample - 1);
+    if(next < stop){
+        CPUTime = next;
+        incCPUTime();
+    }
+    else if(stop != ULONG_MAX)
+        CPUTime = stop;
+}
+
+// Function to find the next time at which the simulation loop must look at the CPU again: the stop time, or the arrival of the next job if it can be admitted
+unsigned long CPU::nextStop(){
+    if(hasPending && jobsInMemory < maxJobs && (unsigned long)pending.arrivalTime < stopTime)
+        return pending.arrivalTime;
+    return stopTime;
 }
 
 // Function to mark a job as complete, generate and return its completion statistics
 stats CPU::completeJob(){
-    PCB j = readyQ.front();
+    int slot = readyQ.front();
+    PCB j = jobTable.get(slot);
     j.shotComplete();
     j.writeEndTime(CPUTime);
-    j.printStats();
+    endShot(slot);
+    if(reports){
+        if(verbose || results){
+            reportRecord r = reportRecord();
+            r.kind = REPORT_JOB;
+            r.job = j.getResult();
+            report(r);
+        }
+    }
+    else{
+        if(verbose)
+            j.printStats();
+        if(results)
+            results->record(j);
+    }
+    if(completions)
+        completions->push_back(j.getResult());
 
     stats s = j.getStats();     // Generate the stats
 
     readyQ.pop();               // Remove this from the ready queue
+    jobTable.release(slot);     // Its slot in the pool can be used by the next job
+    lastRun = -1;
     jobsInMemory--;             // Decrease number of jobs in memory by 1
     jobsComplete++;             // Increase the number of jobs completed
+    events++;
 
     return s;
 }
 
-// Function to sort the ready queue based on the shortest processing time of current burst (used in SJF)
-bool CPU::sortReadyQ(){
-    if (!readyQ.size())
-        return false;
+// Function to preempt the first job in the ready queue (used when time quantum expires)
+void CPU::preemptJob(){
+    if(readyQ.size()){
+        int slot = readyQ.front();
+        PCB j = jobTable.get(slot);
+        j.setState(STATE_READY);        // Set state to ready
+        j.resetQuantum();               // Reset the time quantum as it will start from 0 in the next quantum burst
+        j.shotComplete();               // Signal the shot has been completed
+        endShot(slot);
+        if(trace)
+            trace->preemption(j.getID(), CPUTime);
 
-    // Empty the queue into a vector that can be sorted
-    vector<PCB> tempVec;
-    while(readyQ.size()){
-        tempVec.push_back(readyQ.front());
-        readyQ.pop();
+        readyQ.pop();                   // Remove it from the front of the ready queue
+        readyQ.push(slot, readyKey(slot));  // Add this to the end of the ready queue
+        preemptions++;
+        events++;
     }
-    // Sort the vector based on the processing time of burst (isBurstGreaterThan is defined in PCB.h)
-    sort(tempVec.begin(), tempVec.end(), isBurstGreaterThan);
-    // Add the sorted list back to the ready queue
-    while(tempVec.size()){
-        readyQ.push(tempVec.at(0));
-        tempVec.erase(tempVec.begin());
+}
+
+/* Function to compute the key a job is ordered by in the ready queue (look at ReadyQueue.h)
+ * The key of a priority is the time at which the job reaches the highest priority by aging, so jobs leave the queue
+ * in order of aged priority without ever updating the keys of jobs already in the queue
+ */
+long CPU::readyKey(int slot){
+    PCB job = jobTable.get(slot);
+    switch(readyQ.getOrder()){
+    case ORDER_SHORTEST:
+        return job.getThisBurst();
+    case ORDER_REMAINING:
+        return job.getBurstRemaining();
+    case ORDER_LEVEL:
+        return job.getLevel();
+    case ORDER_PRIORITY:
+        return priorityKey(job, CPUTime);
     }
-    return true;
+    return 0;
 }
 
-// Function to preempt the first job in the ready queue (used when time quantum expires)
-void CPU::preemptJob(){
-    if(readyQ.size()){
-        PCB *j = &(readyQ.front());
-        j->setState(STATE_READY);       // Set state to ready
-        j->resetQuantum();              // Reset the time quantum as it will start from 0 in the next quantum burst
-        j->shotComplete();              // Signal the shot has been completed
+/* Function to save the state of the simulation, with the statistics collected so far and the position in the job queue, to a snapshot file
+ * Options that only affect how the simulation is run or reported (verbose, results, stop time, admission on arrival) are not saved
+ * Returns false if the job queue can't be resumed (e.g. it is read from standard input) or the file can't be written
+ */
+bool CPU::saveSnapshot(string filename, stats &myStats, JobSource &jobQ){
+    SnapshotWriter out;
+    out.put(CPUTime); out.put(events);
+    out.put(jobsInMemory); out.put(maxJobs); out.put(quantum); out.put(jobsComplete); out.put(priorityLevels);
+    out.put(agingInterval);
+    out.put(busyTime); out.put(contextSwitches); out.put(preemptions); out.put(admissions); out.put(lastRun);
+    out.put(overheadLeft); out.put(overheadEvents); out.put(overheadTime);
+    out.put(shotOpen); out.put(shotStart); out.put(payingOverhead); out.put(overheadStart);
+    overhead.save(out);
 
-        readyQ.push(readyQ.front());    // Add this to the end of the ready queue
-        readyQ.pop();                   // Remove it from the front of the ready queue
+    out.put(hasPending);
+    if(hasPending){
+        out.put(pending.id); out.put(pending.arrivalTime);
+        out.putVector(vector<int>(pending.bursts, pending.bursts + pending.numBursts));
+    }
+
+    jobTable.save(out);
+    readyQ.save(out);
+    IOBlockeQ.save(out);
+    myStats.save(out);
+    if(!jobQ.saveState(out))
+        return false;
+    return out.save(filename);
+}
+
+/* Function to restore the state of the simulation and the statistics from a snapshot file, and move the job queue
+ * (which must be the one the snapshot was taken with) to where it was
+ * Returns false if the file is not a snapshot, or was taken with a different job queue
+ */
+bool CPU::loadSnapshot(string filename, stats &myStats, JobSource &jobQ){
+    SnapshotReader in;
+    if(!in.open(filename))
+        return false;
+    in.get(CPUTime); in.get(events);
+    in.get(jobsInMemory); in.get(maxJobs); in.get(quantum); in.get(jobsComplete); in.get(priorityLevels);
+    in.get(agingInterval);
+    in.get(busyTime); in.get(contextSwitches); in.get(preemptions); in.get(admissions); in.get(lastRun);
+    in.get(overheadLeft); in.get(overheadEvents); in.get(overheadTime);
+    in.get(shotOpen); in.get(shotStart); in.get(payingOverhead); in.get(overheadStart);
+    overhead.load(in);
+
+    in.get(hasPending);
+    if(hasPending){
+        in.get(pending.id); in.get(pending.arrivalTime);
+        in.getVector(pendingBursts);
+        pending.numBursts = pendingBursts.size();
+        pending.bursts = pendingBursts.data();
     }
+
+    setSampler(sampler);        // The next sample is due at the next multiple of the interval after the restored time
+    return in.good() && jobTable.load(in) && readyQ.load(in) && IOBlockeQ.load(in) && myStats.load(in) &&
+           jobQ.loadState(in);
 }
 
+// Function to read the total time charged for overhead
+unsigned long CPU::getOverheadTime(){
+    unsigned long total = 0;
+    for(int k=0; k<OVERHEAD_KINDS; k++)
+        total += overheadTime[k];
+    return total;
+}
+
+// Function to print the events and time charged for each kind of overhead, and the share of the clock they took
+void CPU::printOverheadStats(){
+    const char *names[OVERHEAD_KINDS] = { "switch", "dispatch", "admit", "io" };
+    printf("%-8s %10s %12s %10s\n", "overhead", "events", "time", "share");
+    unsigned long events = 0;
+    for(int k=0; k<OVERHEAD_KINDS; k++){
+        printf("%-8s %10lu %12lu %9.2f%%\n", names[k], overheadEvents[k], overheadTime[k],
+               CPUTime ? 100.0*overheadTime[k]/CPUTime : 0.0);
+        events += overheadEvents[k];
+    }
+    printf("%-8s %10lu %12lu %9.2f%%\n", "total", events, getOverheadTime(),
+           CPUTime ? 100.0*getOverheadTime()/CPUTime : 0.0);
+}
 
 // Function to print the number of jobs in ready queue, IO blocked queue, and number of jobs completed
 void CPU::printCPUState(){
-    cout << "Number of jobs in ReadyQueue = " << readyJobs() << endl;
-    cout << "Number of jobs in BlockedQueue = " << IOBlockeQ.size() << endl;
-    cout << "Number of jobs completed = " << jobsComplete << endl << endl;
+    if(reports){
+        reportRecord r = reportRecord();
+        r.kind = REPORT_STATE;
+        r.ready = readyJobs();
+        r.blocked = IOBlockeQ.size();
+        r.completed = jobsComplete;
+        report(r);
+    }
+    else
+        printState(readyJobs(), IOBlockeQ.size(), jobsComplete);
+}
+
+// Function to print a state of the CPU
+void printState(long ready, long blocked, long completed){
+    cout << "Number of jobs in ReadyQueue = " << ready << "\n";
+    cout << "Number of jobs in BlockedQueue = " << blocked << "\n";
+    cout << "Number of jobs completed = " << completed << "\n\n";
+}
+
+// Function to pass a completed job or CPU state to the reporter thread, in batches
+void CPU::report(const reportRecord &r){
+    reportBatch.push_back(r);
+    if(reportBatch.size() >= REPORT_BATCH)
+        flushReports();
+}
+
+// Function to pass the reports not passed on yet to the reporter thread
+void CPU::flushReports(){
+    if(reports)
+        reports->pushAll(reportBatch.data(), reportBatch.size());
+    reportBatch.clear();
 }
 
 #endif // CPU_H_INCLUDED
@@ -0,0 +1,426 @@
+/**
+ * This file contains the Cluster class. It is used to simulate a fleet of CPUs (nodes) behind a load balancer.
+ *
+ * Every node is a CPU of its own (look at CPU.h), with its own memory, ready queue, IO devices and scheduling policy.
+ * A dispatcher reads the jobs from the one shared job source and routes each job to a node when it arrives:
+ *      rr              - round robin over the nodes
+ *      least-loaded    - the node with the fewest jobs routed to it and not completed yet
+ *      p2c             - power of two choices: the less loaded of two nodes picked at random
+ * A node admits the jobs routed to it once they have arrived and there is room in its memory, in the order they were
+ * routed, so jobs that don't fit wait at the node.
+ *
+ * The nodes are split into shards, one per thread, and simulated in parallel in windows of time. Nodes only interact
+ * through the dispatcher, so the windows are conservative: at the start of each window the dispatcher routes every job
+ * arriving before its end, with the load of every node as it was at the start of the window (plus the jobs routed
+ * since), and then every shard runs its nodes up to the end of the window. A node never has to go back in time, and the
+ * results are the same whatever the number of threads. Like a real load balancer, the dispatcher works with load that
+ * is up to one window old: a smaller window makes it more accurate and a larger one makes the threads wait on each
+ * other less often. Windows in which every node is idle are skipped.
+ *
+ * Requires CPU.h, stats.h, scheduler.h, JobSource.h, Workload.h (for Random)
+ */
+
+#ifndef CLUSTER_H_INCLUDED
+#define CLUSTER_H_INCLUDED
+
+#include "scheduler.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <algorithm>
+#include <cstdio>
+
+#define DISPATCH_RR 0
+#define DISPATCH_LEAST_LOADED 1
+#define DISPATCH_P2C 2
+
+#define CLUSTER_WINDOW 1000     // Default length of a window of time
+
+using namespace std;
+
+// Function to parse the name of a dispatcher. Returns -1 if it is not a dispatcher
+int parseDispatcher(string name){
+    const char *names[] = { "rr", "least-loaded", "p2c" };
+    for(int i=0; i<3; i++)
+        if(name == names[i])
+            return i;
+    return -1;
+}
+
+/* Job source of one node: the jobs the dispatcher routed to it, in the order they were routed
+ * The jobs of each window are added as one chunk of ints (ID, arrival time as two ints, number of bursts and the bursts,
+ * as in Pipeline.h). A chunk is freed once a job of a later chunk is read, as the CPU may still hold the last job read,
+ * and its memory is kept for a later chunk
+ */
+class NodeJobSource : public JobSource{
+private:
+    deque<vector<int> > chunks;
+    vector<int> spare;          // Memory of the last chunk freed
+    size_t pos;                 // Next int to read in the first chunk
+    unsigned long lastWindow;   // Window the last chunk was added in
+public:
+    NodeJobSource()             { pos = 0; lastWindow = ULONG_MAX; }
+    bool done()                 { return chunks.empty() || (chunks.size() == 1 && pos == chunks.front().size()); }
+    bool next(jobRecord &job);
+    void add(const int *job, size_t n, unsigned long window);
+};
+
+// Function to read the next job
+bool NodeJobSource::next(jobRecord &job){
+    if(done())
+        return false;
+    if(pos == chunks.front().size()){
+        spare.swap(chunks.front());
+        spare.clear();
+        chunks.pop_front();
+        pos = 0;
+    }
+    int *words = chunks.front().data() + pos;
+    job.id = words[0];
+    job.arrivalTime = (long)((unsigned long)(unsigned int)words[1] | (unsigned long)(unsigned int)words[2] << 32);
+    job.numBursts = words[3];
+    job.bursts = words + 4;
+    pos += 4 + job.numBursts;
+    return true;
+}
+
+// Function to add a job of n ints routed in a window (the first job of a window starts a new chunk)
+void NodeJobSource::add(const int *job, size_t n, unsigned long window){
+    if(window != lastWindow){
+        chunks.push_back(vector<int>());
+        chunks.back().swap(spare);
+        lastWindow = window;
+    }
+    chunks.back().insert(chunks.back().end(), job, job + n);
+}
+
+// State of one node
+struct clusterNode{
+    CPU cpu;
+    NodeJobSource jobs;
+    stats jobStats;
+    clusterNode(int memory, int io) : cpu(memory, io)  { }
+    bool busy()                 { return cpu.memoryUsed() || cpu.pendingJob() || !jobs.done(); }   // Has the node any job left?
+};
+
+// Barrier the threads meet at between the phases of a window
+class WindowBarrier{
+private:
+    mutex lock;
+    condition_variable allHere;
+    int count, waiting;
+    unsigned long generation;
+public:
+    WindowBarrier(int n)        { count = n; waiting = 0; generation = 0; }
+    void wait();
+};
+
+// Function to wait until all the threads have reached the barrier
+void WindowBarrier::wait(){
+    unique_lock<mutex> guard(lock);
+    unsigned long g = generation;
+    if(++waiting == count){
+        waiting = 0;
+        generation++;
+        allHere.notify_all();
+    }
+    else
+        allHere.wait(guard, [&](){ return generation != g; });
+}
+
+class Cluster{
+private:
+    vector<clusterNode*> nodes;
+    int dispatcher, nextNode;
+    unsigned long window, stopTime, CPUTime;
+    bool eventDriven;
+    Random rng;                 // Choices of the p2c dispatcher
+    jobRecord next;             // Next job of the job source, read but not routed yet because it arrives in a later window
+    bool hasNext;
+    vector<int> routed;         // Jobs routed in the current window: node, then the job as in a NodeJobSource
+    unsigned long windows;      // Windows simulated so far
+    vector<long> loads;         // Jobs routed to each node and not completed yet (as of the start of the current window)
+    vector<pair<long, int> > loadHeap;  // Min-heap of (load, node) for the least loaded dispatcher
+    bool heapReady;
+    stats fleetStats;
+
+    int  pickNode();
+    void route(JobSource &jobQ, unsigned long end);
+    template <class Policy>
+    long runShard(Policy policy, int shard, int shards, unsigned long end);
+public:
+    Cluster(int numNodes, int memory, int io, int disp, unsigned long w, bool e);
+    ~Cluster();
+    void setStopTime(unsigned long t)   { stopTime = t; }   // Stop the simulation when the clock reaches this time
+    void configureIO(const vector<long> &serviceTimes);
+    void setOverhead(const Overhead &o);
+    template <class Policy>
+    bool run(JobSource &jobQ, Policy policy, int threads);
+    unsigned long getCPUTime()  { return CPUTime; }         // Read the clock (the time the last node stopped)
+    stats &getStats()           { return fleetStats; }      // Statistics of every job completed on every node
+    void printNodeStats();
+    bool writeNodeStats(string filename);
+};
+
+/* Class constructor
+ * @param: numNodes - number of nodes
+           memory - number of jobs that fit in the memory of each node
+           io - time an IO operation takes on each node's IO device
+           disp - dispatcher (DISPATCH_RR, DISPATCH_LEAST_LOADED or DISPATCH_P2C)
+           w - length of a window of time
+           e - simulate the nodes with the event driven engine
+*/
+Cluster::Cluster(int numNodes, int memory, int io, int disp, unsigned long w, bool e){
+    dispatcher = disp;
+    nextNode = 0;
+    window = max(w, 1UL);
+    stopTime = ULONG_MAX;
+    CPUTime = 0;
+    eventDriven = e;
+    hasNext = false;
+    heapReady = false;
+    windows = 0;
+    loads.resize(numNodes, 0);
+    for(int n=0; n<numNodes; n++){
+        nodes.push_back(new clusterNode(memory, io));
+        nodes[n]->cpu.setVerbose(false);
+        nodes[n]->cpu.setAdmitOnArrival(true);
+    }
+}
+
+// Class destructor
+Cluster::~Cluster(){
+    for(size_t n=0; n<nodes.size(); n++)
+        delete nodes[n];
+}
+
+// Function to give every node IO devices with these service times (check IOSubsystem.h)
+void Cluster::configureIO(const vector<long> &serviceTimes){
+    for(size_t n=0; n<nodes.size(); n++)
+        nodes[n]->cpu.getIO().configure(serviceTimes);
+}
+
+// Function to charge the same overhead on every node (each node draws its costs from its own copy, check Overhead.h)
+void Cluster::setOverhead(const Overhead &o){
+    for(size_t n=0; n<nodes.size(); n++)
+        nodes[n]->cpu.getOverhead() = o;
+}
+
+// Function to pick the node the next job is routed to
+int Cluster::pickNode(){
+    int count = nodes.size();
+    if(dispatcher == DISPATCH_RR){
+        int n = nextNode;
+        nextNode = (nextNode + 1) % count;
+        return n;
+    }
+    if(dispatcher == DISPATCH_P2C){
+        if(count == 1)
+            return 0;
+        int a = rng.next() % count;
+        int b = (a + 1 + rng.next() % (count - 1)) % count;    // A different node
+        return loads[b] < loads[a] ? b : a;
+    }
+
+    // Least loaded: the heap is built from the load of every node the first time a job is routed in a window, and only
+    // the node picked changes until the next window. Ties go to the node with the smaller index
+    if(!heapReady){
+        loadHeap.clear();
+        for(int n=0; n<count; n++)
+            loadHeap.push_back(make_pair(loads[n], n));
+        make_heap(loadHeap.begin(), loadHeap.end(), greater<pair<long, int> >());
+        heapReady = true;
+    }
+    pop_heap(loadHeap.begin(), loadHeap.end(), greater<pair<long, int> >());
+    int n = loadHeap.back().second;
+    loadHeap.back().first++;
+    push_heap(loadHeap.begin(), loadHeap.end(), greater<pair<long, int> >());
+    return n;
+}
+
+/* Function to route every job arriving before end to a node
+ * The jobs are only collected here, in one buffer, and every shard passes its own jobs to its nodes, so the part of a
+ * window that runs on one thread is as short as possible
+ */
+void Cluster::route(JobSource &jobQ, unsigned long end){
+    heapReady = false;
+    routed.clear();
+    while(hasNext && (unsigned long)next.arrivalTime < end){
+        int n = pickNode();
+        unsigned long arrival = next.arrivalTime;
+        routed.push_back(n);
+        routed.push_back(next.id);
+        routed.push_back((int)(arrival & 0xffffffffUL));
+        routed.push_back((int)(arrival >> 32));
+        routed.push_back(next.numBursts);
+        routed.insert(routed.end(), next.bursts, next.bursts + next.numBursts);
+        loads[n]++;
+        hasNext = jobQ.next(next);
+    }
+}
+
+/* Function to run the nodes of one shard (a block of nodes) up to the end of a window, once the jobs of the window are routed
+ * Returns the number of nodes of the shard with jobs left
+ */
+template <class Policy>
+long Cluster::runShard(Policy policy, int shard, int shards, unsigned long end){
+    int first = nodes.size()*shard/shards, last = nodes.size()*(shard + 1)/shards;
+    for(size_t i=0; i<routed.size(); i += 5 + routed[i + 4])
+        if(routed[i] >= first && routed[i] < last)
+            nodes[routed[i]]->jobs.add(&routed[i + 1], 4 + routed[i + 4], windows);
+
+    long active = 0;
+    for(int n=first; n<last; n++){
+        clusterNode &node = *nodes[n];
+        if(!node.busy())
+            continue;
+        int completed = node.cpu.jobsCompleted();
+        node.cpu.setStopTime(end);
+        runSimulation(node.jobs, policy, node.cpu, node.jobStats, eventDriven);
+        loads[n] -= node.cpu.jobsCompleted() - completed;
+        active += node.busy();
+    }
+    return active;
+}
+
+/* Function to simulate a policy on every node until every job is complete (or the stop time)
+ * @param: threads - number of threads to simulate the nodes on (0 means one per hardware thread)
+ * Returns false if the policy rejected its parameters
+ */
+template <class Policy>
+bool Cluster::run(JobSource &jobQ, Policy policy, int threads){
+    if(!policy.init(nodes[0]->cpu))
+        return false;
+    if(threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+    threads = min((size_t)threads, nodes.size());
+
+    // The main thread routes the jobs and runs the first shard. Every window, the threads meet once the jobs are
+    // routed and once every shard has reached the end of the window
+    WindowBarrier barrier(threads);
+    vector<long> active(threads, 0);
+    unsigned long start = 0, end = 0;
+    bool finished = false;
+    vector<thread> pool;
+    for(int t=1; t<threads; t++)
+        pool.push_back(thread([&, t](){
+            while(true){
+                barrier.wait();
+                if(finished)
+                    return;
+                active[t] = runShard(policy, t, threads, end);
+                barrier.wait();
+            }
+        }));
+
+    hasNext = jobQ.next(next);
+    long busyNodes = 0;
+    while(true){
+        // Skip ahead to the next arrival if every node is idle
+        if(!busyNodes && hasNext)
+            start = max(start, (unsigned long)next.arrivalTime);
+        finished = (!busyNodes && !hasNext) || start >= stopTime;
+        if(finished){
+            barrier.wait();
+            break;
+        }
+        end = start + min(window, stopTime - start);
+        route(jobQ, end);
+
+        barrier.wait();
+        active[0] = runShard(policy, 0, threads, end);
+        barrier.wait();
+
+        busyNodes = 0;
+        for(int t=0; t<threads; t++)
+            busyNodes += active[t];
+        start = end;
+        windows++;
+    }
+    for(size_t t=0; t<pool.size(); t++)
+        pool[t].join();
+
+    CPUTime = 0;
+    for(size_t n=0; n<nodes.size(); n++){
+        CPUTime = max(CPUTime, nodes[n]->cpu.getCPUTime());
+        fleetStats.addStats(nodes[n]->jobStats);
+    }
+    return true;
+}
+
+/* Function to simulate a policy on a cluster and print the summary statistics of the whole fleet at the end of simulation
+ * Returns false if the policy rejected its parameters
+ */
+template <class Policy>
+bool simulateCluster(JobSource &JobQ, Policy policy, Cluster &fleet, int threads){
+    if(!fleet.run(JobQ, policy, threads)){
+        cout << "Invalid time quantum!";
+        return false;
+    }
+
+    // Print summary statistics of simulation
+    cout << policy.name();
+    cout << "CPU clock value = " << fleet.getCPUTime() << endl;
+    fleet.getStats().printStats();
+    return true;
+}
+
+// Function to find the value at a percentile of a list of values (the list is sorted)
+double percentileOf(vector<double> &values, double p){
+    if(values.empty())
+        return 0;
+    sort(values.begin(), values.end());
+    return values[(size_t)(p/100*(values.size() - 1) + 0.5)];
+}
+
+// Function to print the utilization of the fleet, the load imbalance and how utilization and latency vary between nodes
+void Cluster::printNodeStats(){
+    const char *names[] = { "jobs", "utilization %", "average wait", "average turn around", "p99 turn around" };
+    vector<double> values[5];
+    unsigned long totalBusy = 0, maxBusy = 0;
+    for(size_t n=0; n<nodes.size(); n++){
+        clusterNode &node = *nodes[n];
+        long jobs = node.jobStats.getCount();
+        values[0].push_back(jobs);
+        values[1].push_back(CPUTime ? 100.0*node.cpu.getBusyTime()/CPUTime : 0.0);
+        if(jobs){
+            values[2].push_back((double)node.jobStats.getwTime()/jobs);
+            values[3].push_back((double)node.jobStats.gettaTime()/jobs);
+            values[4].push_back(node.jobStats.gettaTimeHist().percentile(99));
+        }
+        totalBusy += node.cpu.getBusyTime();
+        maxBusy = max(maxBusy, node.cpu.getBusyTime());
+    }
+    double meanBusy = (double)totalBusy/nodes.size();
+    printf("Nodes = %lu, dispatcher = %s\n", (unsigned long)nodes.size(),
+           dispatcher == DISPATCH_RR ? "rr" : dispatcher == DISPATCH_LEAST_LOADED ? "least-loaded" : "p2c");
+    printf("Fleet utilization = %.2f%%\n", CPUTime ? 100.0*meanBusy/CPUTime : 0.0);
+    printf("Load imbalance (busiest node / average) = %.3f\n", meanBusy ? maxBusy/meanBusy : 1.0);
+    printf("%-20s %12s %12s %12s %12s\n", "per node", "min", "p50", "p99", "max");
+    for(int m=0; m<5; m++)
+        printf("%-20s %12.2f %12.2f %12.2f %12.2f\n", names[m], percentileOf(values[m], 0), percentileOf(values[m], 50),
+               percentileOf(values[m], 99), percentileOf(values[m], 100));
+}
+
+/* Function to write the utilization and latency of every node to a CSV file, one row per node:
+ *      node,jobs,busy_time,utilization,avg_wait,avg_turnaround,p99_turnaround,context_switches
+ * Returns false if the file can't be written
+ */
+bool Cluster::writeNodeStats(string filename){
+    FILE *out = fopen(filename.c_str(), "w");
+    if(!out)
+        return false;
+    fprintf(out, "node,jobs,busy_time,utilization,avg_wait,avg_turnaround,p99_turnaround,context_switches\n");
+    for(size_t n=0; n<nodes.size(); n++){
+        clusterNode &node = *nodes[n];
+        long jobs = node.jobStats.getCount();
+        fprintf(out, "%lu,%ld,%lu,%.4f,%.2f,%.2f,%ld,%lu\n", (unsigned long)n, jobs, node.cpu.getBusyTime(),
+                CPUTime ? (double)node.cpu.getBusyTime()/CPUTime : 0.0, jobs ? (double)node.jobStats.getwTime()/jobs : 0.0,
+                jobs ? (double)node.jobStats.gettaTime()/jobs : 0.0, jobs ? node.jobStats.gettaTimeHist().percentile(99) : 0,
+                node.cpu.getContextSwitches());
+    }
+    return fclose(out) == 0;
+}
+
+#endif // CLUSTER_H_INCLUDED
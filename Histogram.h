@@ -0,0 +1,122 @@
+/**
+ * This file contains the Histogram class. It counts how often each value of a metric occurred, so percentiles of the
+ * metric can be read at the end of a simulation without keeping every value.
+ *
+ * Values are counted in logarithmic buckets (like an HDR histogram): every value below 2*HIST_SUB_BUCKETS has its own
+ * bucket, and each power of two above that is split into HIST_SUB_BUCKETS buckets. So a percentile is never off by
+ * more than 1/HIST_SUB_BUCKETS of its value, and a histogram never needs more than about 7300 buckets whatever the
+ * values are. Negative values are counted as 0.
+ *
+ * Two histograms are merged by adding their counts, so runs made in parallel can be combined at the end.
+ */
+
+#ifndef HISTOGRAM_H_INCLUDED
+#define HISTOGRAM_H_INCLUDED
+
+#include <vector>
+#include <algorithm>
+#include "Snapshot.h"
+
+#define HIST_SUB_BITS 7
+#define HIST_SUB_BUCKETS (1 << HIST_SUB_BITS)
+
+using namespace std;
+
+class Histogram{
+private:
+    vector<unsigned long> counts;   // Grows to the highest bucket used so far
+    unsigned long total;
+    long maxValue;
+    static int bucketOf(long v);
+    static long highestIn(int b);
+    static long lowestIn(int b);
+public:
+    Histogram()                 { total = 0; maxValue = 0; }
+    unsigned long getCount() const { return total; }            // Read the number of values recorded
+    long getMax() const         { return maxValue; }            // Read the largest value recorded (exact)
+    void record(long v);
+    void merge(const Histogram &h);
+    long percentile(double p);
+    void largest(unsigned long m, vector<long> &values);
+    void save(SnapshotWriter &out)  { out.putVector(counts); out.put(total); out.put(maxValue); }   // Write the counts to a snapshot
+    bool load(SnapshotReader &in)   { return in.getVector(counts) && in.get(total) && in.get(maxValue); }  // Read the counts back from a snapshot
+};
+
+// Function to find the bucket a value is counted in
+inline int Histogram::bucketOf(long v){
+    if(v < 2*HIST_SUB_BUCKETS)
+        return v;
+    int shift = (63 - __builtin_clzl(v)) - HIST_SUB_BITS;
+    return (shift + 1)*HIST_SUB_BUCKETS + (int)((v >> shift) - HIST_SUB_BUCKETS);
+}
+
+// Function to find the largest value counted in a bucket
+inline long Histogram::highestIn(int b){
+    if(b < 2*HIST_SUB_BUCKETS)
+        return b;
+    int shift = b/HIST_SUB_BUCKETS - 1;
+    long low = (long)(b%HIST_SUB_BUCKETS + HIST_SUB_BUCKETS) << shift;
+    return low + ((1L << shift) - 1);
+}
+
+// Function to find the smallest value counted in a bucket
+inline long Histogram::lowestIn(int b){
+    if(b < 2*HIST_SUB_BUCKETS)
+        return b;
+    int shift = b/HIST_SUB_BUCKETS - 1;
+    return (long)(b%HIST_SUB_BUCKETS + HIST_SUB_BUCKETS) << shift;
+}
+
+// Function to count one value
+inline void Histogram::record(long v){
+    if(v < 0)
+        v = 0;
+    size_t b = bucketOf(v);
+    if(b >= counts.size())
+        counts.resize(b + 1);
+    counts[b]++;
+    total++;
+    maxValue = max(maxValue, v);
+}
+
+// Function to add the counts of another histogram to this one
+void Histogram::merge(const Histogram &h){
+    if(h.counts.size() > counts.size())
+        counts.resize(h.counts.size());
+    for(size_t b=0; b<h.counts.size(); b++)
+        counts[b] += h.counts[b];
+    total += h.total;
+    maxValue = max(maxValue, h.maxValue);
+}
+
+/* Function to read the value below or at which p percent of the values recorded are (e.g. p = 99.9)
+ * The value returned is the largest value of the bucket the percentile falls in (but never more than the maximum)
+ */
+long Histogram::percentile(double p){
+    if(!total)
+        return 0;
+    // Rank of the value asked for, counting from 1
+    unsigned long rank = (unsigned long)(p/100*total + 0.5);
+    rank = max(1UL, min(rank, total));
+
+    unsigned long seen = 0;
+    for(size_t b=0; b<counts.size(); b++){
+        seen += counts[b];
+        if(seen >= rank)
+            return min(highestIn(b), maxValue);
+    }
+    return maxValue;
+}
+
+/* Function to add the m largest values recorded (or all of them, if there are fewer) to values, largest first
+ * Each value added is the smallest value of its bucket, so it is never more than the value recorded
+ */
+void Histogram::largest(unsigned long m, vector<long> &values){
+    for(size_t b=counts.size(); b-- > 0 && m; ){
+        unsigned long n = min(counts[b], m);
+        values.insert(values.end(), n, lowestIn(b));
+        m -= n;
+    }
+}
+
+#endif // HISTOGRAM_H_INCLUDED
@@ -0,0 +1,159 @@
+/**
+ * This file contains the IOSubsystem class. It models the IO devices jobs perform IO on between their CPU bursts.
+ *
+ * There can be any number of devices, each with its own service time (the time one IO operation takes on it). A job
+ * blocking for IO is queued on the device that becomes free first, and its IO completes one service time after the
+ * device is free. With one device this is the IO model of the original simulator: IO operations are performed one at
+ * a time, in the order the jobs blocked.
+ *
+ * Free devices and pending completions are both kept in min-heaps, so starting an IO operation or completing one is
+ * O(log n), and any number of jobs can complete IO at the same instant.
+ *
+ * For every device the number of requests, the time it was busy and the time jobs queued waiting for it are recorded.
+ */
+
+#ifndef IOSUBSYSTEM_H_INCLUDED
+#define IOSUBSYSTEM_H_INCLUDED
+
+#include <queue>
+#include <vector>
+#include <climits>
+#include <cstdio>
+#include <functional>
+#include <algorithm>
+#include "Snapshot.h"
+
+using namespace std;
+
+// State and statistics of one IO device
+struct ioDevice{
+    long serviceTime;
+    unsigned long freeAt;           // Time the device finishes the last IO queued on it
+    unsigned long requests, busyTime, queueDelay, maxQueueDelay;
+};
+
+// IO completion (or device becoming free) waiting in a heap, ordered by time and then by the order it was added
+struct ioEvent{
+    unsigned long time, seq;
+    int id;                         // Slot of the job for a completion, device for a free device
+};
+
+inline bool operator>(const ioEvent &a, const ioEvent &b){
+    return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+}
+
+class IOSubsystem{
+private:
+    vector<ioDevice> devices;
+    unsigned long seq;
+    priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> > freeDevices;   // Every device, by the time it is free
+    priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> > completions;   // Jobs performing IO, by completion time
+public:
+    IOSubsystem(int numDevices = 1, long serviceTime = 10)     { configure(vector<long>(numDevices, serviceTime)); }
+    void configure(vector<long> serviceTimes);
+    int  numDevices()           { return devices.size(); }          // Read the number of devices
+    int  size()                 { return completions.size(); }      // Read the number of jobs performing or waiting for IO
+    unsigned long nextCompletion()  { return completions.size() ? completions.top().time : ULONG_MAX; }   // Read the time of the next IO completion
+    unsigned long start(unsigned long now, long &serviceTime, int *device = NULL);
+    unsigned long submit(int slot, unsigned long now, long &serviceTime, int *device = NULL);
+    int  complete();
+    void printIOStats(unsigned long clock);
+    void save(SnapshotWriter &out);
+    bool load(SnapshotReader &in);
+};
+
+/* Function to set up the devices, one per service time given, all free and with no statistics yet
+ * Jobs still performing IO are dropped, so this is meant to be used before the simulation starts
+ */
+void IOSubsystem::configure(vector<long> serviceTimes){
+    devices.clear();
+    seq = 0;
+    freeDevices = priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> >();
+    completions = priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> >();
+    for(size_t d=0; d<serviceTimes.size(); d++){
+        ioDevice dev = { serviceTimes[d], 0, 0, 0, 0, 0 };
+        devices.push_back(dev);
+        ioEvent e = { 0, d, (int)d };        // Devices free at the same time are used in order
+        freeDevices.push(e);
+    }
+}
+
+/* Function to queue an IO operation requested at time now on the device that is free first
+ * Returns the time at which the operation completes, and the service time of the device it was queued on in serviceTime
+ * (and the device in device, if given). The completion is not kept track of (use submit() for that)
+ */
+unsigned long IOSubsystem::start(unsigned long now, long &serviceTime, int *device){
+    ioEvent e = freeDevices.top();
+    freeDevices.pop();
+    ioDevice &dev = devices[e.id];
+
+    unsigned long begin = max(dev.freeAt, now);
+    dev.freeAt = begin + dev.serviceTime;
+    dev.requests++;
+    dev.busyTime += dev.serviceTime;
+    dev.queueDelay += begin - now;
+    dev.maxQueueDelay = max(dev.maxQueueDelay, begin - now);
+
+    e.time = dev.freeAt;
+    freeDevices.push(e);
+    serviceTime = dev.serviceTime;
+    if(device)
+        *device = e.id;
+    return dev.freeAt;
+}
+
+/* Function to start an IO operation for the job in a slot and keep track of when it completes
+ * Returns the completion time, and the service time of the device it was queued on in serviceTime (and the device in device, if given)
+ */
+unsigned long IOSubsystem::submit(int slot, unsigned long now, long &serviceTime, int *device){
+    ioEvent e;
+    e.time = start(now, serviceTime, device);
+    e.seq = seq++;
+    e.id = slot;
+    completions.push(e);
+    return e.time;
+}
+
+// Function to remove the job whose IO completes next and return its slot (jobs completing at the same time leave in the order they were submitted)
+int IOSubsystem::complete(){
+    int slot = completions.top().id;
+    completions.pop();
+    return slot;
+}
+
+// Function to print the service time, requests, utilization and queueing delay of every device
+void IOSubsystem::printIOStats(unsigned long clock){
+    printf("%-7s %8s %10s %12s %11s %15s %15s\n", "device", "service", "requests", "busy_time", "utilization",
+           "avg_queue_delay", "max_queue_delay");
+    for(size_t d=0; d<devices.size(); d++){
+        ioDevice &dev = devices[d];
+        printf("%-7d %8ld %10lu %12lu %10.2f%% %15.2f %15lu\n", (int)d, dev.serviceTime, dev.requests, dev.busyTime,
+               clock ? 100.0*dev.busyTime/clock : 0.0, dev.requests ? (double)dev.queueDelay/dev.requests : 0.0,
+               dev.maxQueueDelay);
+    }
+}
+
+// Function to write the devices and the jobs performing IO to a snapshot
+void IOSubsystem::save(SnapshotWriter &out){
+    vector<ioEvent> freeList, pending;
+    for(priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> > h = freeDevices; h.size(); h.pop())
+        freeList.push_back(h.top());
+    for(priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> > h = completions; h.size(); h.pop())
+        pending.push_back(h.top());
+    out.putVector(devices);
+    out.put(seq);
+    out.putVector(freeList);
+    out.putVector(pending);
+}
+
+// Function to replace the devices and the jobs performing IO with those of a snapshot. Returns false if the snapshot ended
+bool IOSubsystem::load(SnapshotReader &in){
+    vector<ioEvent> freeList, pending;
+    if(!(in.getVector(devices) && in.get(seq) && in.getVector(freeList) && in.getVector(pending)))
+        return false;
+    freeDevices = priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> >(freeList.begin(), freeList.end());
+    completions = priority_queue<ioEvent, vector<ioEvent>, greater<ioEvent> >(pending.begin(), pending.end());
+    return true;
+}
+
+#endif // IOSUBSYSTEM_H_INCLUDED
@@ -0,0 +1,454 @@
+/**
+ * This file contains the job sources the simulator reads jobs from, one job at a time as it admits them into memory.
+ *
+ * TextJobSource reads the text format (one job per line):
+ *      <ID> <ArrivalTime> <NumberOfBursts> <n numbers denoting length of each burst>
+ * BinaryJobSource reads the binary format, which is the same fields as native 32 bit integers behind a small header:
+ *      "CPUSIMTR" <version> <reserved> | <ID> <ArrivalTime> <NumberOfBursts> <bursts...> | <ID> ...
+ * Both map the file into memory instead of reading it. Text lines are only parsed when the job is admitted, and
+ * binary jobs are handed out as pointers into the mapped file, so neither builds a copy of the trace.
+ * StreamJobSource reads the text format from a pipe (e.g. stdin) through a small buffer that is refilled as jobs are
+ * read, so a stream of any length, even one that never ends, is read in constant memory.
+ * A malformed job (e.g. one without bursts, or with a burst shorter than 1) stops the reading: next() returns false, and malformed() tells this apart
+ * from the end of the jobs.
+ */
+
+#ifndef JOBSOURCE_H_INCLUDED
+#define JOBSOURCE_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <cerrno>
+#include <algorithm>
+#include <fstream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "Snapshot.h"
+
+#define TRACE_MAGIC "CPUSIMTR"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_INTS 4     // magic (2 ints), version, reserved
+
+#define SOURCE_TEXT 1           // Kinds of job source, written to snapshots to check a snapshot is resumed from the same kind
+#define SOURCE_BINARY 2
+#define SOURCE_GENERATOR 3
+
+using namespace std;
+
+// A job as read from a job source. bursts stays valid until the next job is read from the same source
+struct jobRecord{
+    int id;
+    long arrivalTime;
+    int numBursts;
+    const int *bursts;
+    jobRecord()     { id = 0; arrivalTime = 0; numBursts = 0; bursts = NULL; }
+};
+
+// Function to check a job has at least one burst and every burst is at least 1 unit of time long
+bool validBursts(const int *bursts, long numBursts){
+    if(numBursts < 1)
+        return false;
+    for(long i=0; i<numBursts; i++)
+        if(bursts[i] < 1)
+            return false;
+    return true;
+}
+
+// Interface of every job source
+class JobSource{
+public:
+    virtual ~JobSource() { }
+    virtual bool done() = 0;                    // Are there no more jobs to read?
+    virtual bool next(jobRecord &job) = 0;      // Read the next job (false if there are no more jobs)
+    virtual bool endless()  { return false; }   // Does the source never run out of jobs?
+    virtual bool malformed()    { return false; }   // Did reading stop at a job that isn't valid (check validBursts())?
+    virtual bool saveState(SnapshotWriter &)    { return false; }   // Write the position of the next job to a snapshot (false if the source can't)
+    virtual bool loadState(SnapshotReader &)    { return false; }   // Continue from the position in a snapshot (false if it isn't a position in this source)
+};
+
+// Read only memory mapping of a whole file
+class MappedFile{
+private:
+    const char *data;
+    size_t length;
+public:
+    MappedFile()                { data = NULL; length = 0; }
+    ~MappedFile()               { close(); }
+    const char *begin()         { return data; }            // First byte of the file
+    const char *end()           { return data + length; }   // One past the last byte of the file
+    size_t size()               { return length; }          // Size of the file in bytes
+    bool open(string filename);
+    void close();
+};
+
+// Function to map a file into memory. Returns false if the file can't be opened or mapped
+bool MappedFile::open(string filename){
+    close();
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat st;
+    if(fstat(fd, &st) < 0){
+        ::close(fd);
+        return false;
+    }
+    length = st.st_size;
+
+    // An empty file can't be mapped, but it is a valid (empty) trace
+    if(length){
+        void *p = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p == MAP_FAILED){
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        madvise(p, length, MADV_SEQUENTIAL);    // The trace is read front to back exactly once
+        data = (const char *)p;
+    }
+    ::close(fd);                                // The mapping stays valid after the descriptor is closed
+    return true;
+}
+
+// Function to unmap the file
+void MappedFile::close(){
+    if(data)
+        munmap((void *)data, length);
+    data = NULL;
+    length = 0;
+}
+
+// Job source reading the text format out of a mapped file
+class TextJobSource : public JobSource{
+protected:
+    MappedFile file;
+    const char *pos, *last;     // Text not parsed yet
+    vector<int> bursts;         // Bursts of the last job read (reused for every job)
+    bool bad;                   // Was reading stopped at a malformed job?
+    bool skipBlank();
+    long readInt();
+public:
+    TextJobSource()             { pos = last = NULL; bad = false; }
+    bool open(string filename)  { bool ok = file.open(filename); pos = file.begin(); last = file.end(); return ok; }
+    bool done()                 { return !skipBlank(); }
+    bool malformed()            { return bad; }
+    bool next(jobRecord &job);
+    bool saveState(SnapshotWriter &out);
+    bool loadState(SnapshotReader &in);
+};
+
+// Function to write the position of the next job (an offset into the file) to a snapshot
+bool TextJobSource::saveState(SnapshotWriter &out){
+    out.put((int)SOURCE_TEXT);
+    out.put((unsigned long)file.size());
+    out.put((unsigned long)(pos - file.begin()));
+    return true;
+}
+
+// Function to continue reading from the position in a snapshot, which must have been taken with a file of the same size
+bool TextJobSource::loadState(SnapshotReader &in){
+    int kind;
+    unsigned long size, offset;
+    if(!(in.get(kind) && in.get(size) && in.get(offset)) || kind != SOURCE_TEXT || size != file.size() || offset > size)
+        return false;
+    pos = file.begin() + offset;
+    return true;
+}
+
+// Function to skip white space and empty lines. Returns false if the end of the file was reached
+bool TextJobSource::skipBlank(){
+    while(pos != last && isspace((unsigned char)*pos))
+        pos++;
+    return pos != last;
+}
+
+// Function to parse the next integer on the current line (0 if the line has no more integers)
+long TextJobSource::readInt(){
+    while(pos != last && (*pos == ' ' || *pos == '\t' || *pos == '\r'))
+        pos++;
+
+    bool negative = false;
+    if(pos != last && *pos == '-'){
+        negative = true;
+        pos++;
+    }
+    long value = 0;
+    while(pos != last && *pos >= '0' && *pos <= '9')
+        value = value*10 + (*pos++ - '0');
+    return negative ? -value : value;
+}
+
+/* Function to parse the next line of the file into a job
+ * A job without bursts, with more bursts than could fit on the rest of the file, or with a burst missing from its line or
+ * shorter than 1 stops the reading as malformed
+ */
+bool TextJobSource::next(jobRecord &job){
+    if(!skipBlank())
+        return false;
+
+    job.id = readInt();
+    job.arrivalTime = readInt();
+    long numBursts = readInt();
+    if(numBursts < 1 || numBursts > last - pos){
+        bad = true;
+        pos = last;
+        return false;
+    }
+    job.numBursts = numBursts;
+    bursts.resize(job.numBursts);
+    for(int i=0; i<job.numBursts; i++)
+        bursts[i] = readInt();      // A burst missing from the line reads as 0
+    job.bursts = bursts.data();
+    if(!validBursts(job.bursts, job.numBursts)){
+        bad = true;
+        pos = last;
+        return false;
+    }
+
+    // Anything left on the line is ignored
+    while(pos != last && *pos != '\n')
+        pos++;
+    return true;
+}
+
+// Job source reading the text format from a file descriptor that can't be mapped (a pipe, stdin or a terminal)
+class StreamJobSource : public TextJobSource{
+private:
+    int fd;
+    bool eof;
+    vector<char> buffer;
+    bool fillLine();
+public:
+    StreamJobSource(int f = 0)  { fd = f; eof = false; buffer.resize(1 << 16); pos = last = buffer.data(); }
+    bool done()                 { return !fillLine(); }
+    bool next(jobRecord &job)   { return fillLine() && TextJobSource::next(job); }
+    bool saveState(SnapshotWriter &)    { return false; }   // A stream can't be read again, so it can't be resumed
+    bool loadState(SnapshotReader &)    { return false; }
+};
+
+/* Function to make sure the next job's whole line is in the buffer, reading more of the stream if it isn't
+ * Returns false if the stream ended before another job
+ */
+bool StreamJobSource::fillLine(){
+    if(bad)
+        return false;
+    while(true){
+        if(skipBlank() && (eof || memchr(pos, '\n', last - pos)))
+            return true;
+        if(eof)
+            return false;
+
+        // Move the start of the line to the front of the buffer (the buffer only grows for lines longer than it)
+        size_t kept = last - pos;
+        memmove(buffer.data(), pos, kept);
+        if(kept == buffer.size())
+            buffer.resize(2*buffer.size());
+        ssize_t n = read(fd, buffer.data() + kept, buffer.size() - kept);
+        if(n < 0 && errno == EINTR)
+            n = 0;
+        else if(n <= 0)
+            eof = true;
+        pos = buffer.data();
+        last = pos + kept + max((ssize_t)0, n);
+    }
+}
+
+// Job source reading the binary format. The jobs can be in a mapped file or in a buffer owned by someone else
+class BinaryJobSource : public JobSource{
+private:
+    MappedFile file;
+    const int *pos, *last;
+    bool bad;                   // Was reading stopped at a malformed job?
+public:
+    BinaryJobSource()           { pos = last = NULL; bad = false; }
+    BinaryJobSource(const int *first, const int *end)   { pos = first; last = end; bad = false; }  // Read jobs from a buffer
+    bool open(string filename);
+    bool done()                 { return pos >= last; }
+    bool malformed()            { return bad; }
+    bool next(jobRecord &job);
+    bool saveState(SnapshotWriter &out);
+    bool loadState(SnapshotReader &in);
+};
+
+// Function to map a binary trace file. Returns false if it can't be opened or doesn't have a valid header
+bool BinaryJobSource::open(string filename){
+    if(!file.open(filename) || file.size() < TRACE_HEADER_INTS*sizeof(int) || memcmp(file.begin(), TRACE_MAGIC, 8))
+        return false;
+    const int *header = (const int *)file.begin();
+    if(header[2] != TRACE_VERSION)
+        return false;
+    pos = header + TRACE_HEADER_INTS;
+    last = (const int *)file.begin() + file.size()/sizeof(int);
+    return true;
+}
+
+// Function to read the next job. The bursts point straight into the trace, nothing is copied
+bool BinaryJobSource::next(jobRecord &job){
+    if(pos >= last)
+        return false;
+
+    // A job cut short at the end of the trace, or without valid bursts, stops the reading as malformed
+    if(last - pos < 3 || pos[2] < 1 || last - pos - 3 < pos[2] || !validBursts(pos + 3, pos[2])){
+        bad = true;
+        pos = last;
+        return false;
+    }
+    job.id = pos[0];
+    job.arrivalTime = pos[1];
+    job.numBursts = pos[2];
+    job.bursts = pos + 3;
+    pos += 3 + job.numBursts;
+    return true;
+}
+
+// Function to write the position of the next job (an offset from the end of the trace) to a snapshot
+bool BinaryJobSource::saveState(SnapshotWriter &out){
+    out.put((int)SOURCE_BINARY);
+    out.put((unsigned long)(last - pos));
+    return true;
+}
+
+// Function to continue reading from the position in a snapshot, which must have been taken with the same trace
+bool BinaryJobSource::loadState(SnapshotReader &in){
+    int kind;
+    unsigned long left;
+    if(!(in.get(kind) && in.get(left)) || kind != SOURCE_BINARY || left > (unsigned long)(last - pos))
+        return false;
+    pos = last - left;
+    return true;
+}
+
+// Function to check if a file starts with the binary trace header
+bool isBinaryTrace(string filename){
+    char magic[8];
+    ifstream f(filename.c_str(), ios::binary);
+    return f.read(magic, 8) && !memcmp(magic, TRACE_MAGIC, 8);
+}
+
+/* Function to open a job file in whichever format it is in ("-" reads text jobs from stdin as they arrive)
+ * Returns NULL if the file can't be opened. The caller owns the returned source
+ */
+JobSource *openJobSource(string filename){
+    if(filename == "-")
+        return new StreamJobSource(0);
+    if(isBinaryTrace(filename)){
+        BinaryJobSource *src = new BinaryJobSource();
+        if(src->open(filename))
+            return src;
+        delete src;
+        return NULL;
+    }
+    TextJobSource *src = new TextJobSource();
+    if(src->open(filename))
+        return src;
+    delete src;
+    return NULL;
+}
+
+// Function to write the binary trace header
+void writeTraceHeader(ostream &out){
+    int header[TRACE_HEADER_INTS] = { 0, 0, TRACE_VERSION, 0 };
+    memcpy(header, TRACE_MAGIC, 8);
+    out.write((const char *)header, sizeof(header));
+}
+
+// Function to append one job to a buffer in the binary trace format
+void appendTraceRecord(vector<int> &buffer, const jobRecord &job){
+    buffer.push_back(job.id);
+    buffer.push_back(min(job.arrivalTime, (long)INT_MAX));     // The binary format only holds 32 bit arrival times
+    buffer.push_back(job.numBursts);
+    buffer.insert(buffer.end(), job.bursts, job.bursts + job.numBursts);
+}
+
+/* Function to read every job of a source into a buffer in the binary trace format (without the header)
+ * The buffer can then be shared, read only, by any number of BinaryJobSources. Returns the number of jobs read
+ */
+long readTrace(JobSource &src, vector<int> &buffer){
+    jobRecord job;
+    long count = 0;
+    while(src.next(job)){
+        appendTraceRecord(buffer, job);
+        count++;
+    }
+    return count;
+}
+
+/* Function to convert every job of a source into a binary trace file
+ * Returns the number of jobs written, or -1 if the output file can't be written
+ */
+long convertTrace(JobSource &src, string filename){
+    ofstream out(filename.c_str(), ios::binary);
+    if(!out)
+        return -1;
+    writeTraceHeader(out);
+
+    // Jobs are collected in a buffer and written out in large blocks
+    vector<int> buffer;
+    jobRecord job;
+    long count = 0;
+    while(src.next(job)){
+        appendTraceRecord(buffer, job);
+        count++;
+        if(buffer.size() >= (1 << 16)){
+            out.write((const char *)buffer.data(), buffer.size()*sizeof(int));
+            buffer.clear();
+        }
+    }
+    out.write((const char *)buffer.data(), buffer.size()*sizeof(int));
+    return out ? count : -1;
+}
+
+// Function to append an integer in decimal to a character buffer
+void appendInt(vector<char> &buffer, long value){
+    char digits[24];
+    int n = 0;
+    unsigned long v = value < 0 ? -(unsigned long)value : value;
+    do{
+        digits[n++] = '0' + v%10;
+        v /= 10;
+    }while(v);
+    if(value < 0)
+        buffer.push_back('-');
+    while(n)
+        buffer.push_back(digits[--n]);
+}
+
+/* Function to write every job of a source into a text job file
+ * Returns the number of jobs written, or -1 if the output file can't be written
+ */
+long writeTextTrace(JobSource &src, string filename){
+    ofstream out(filename.c_str(), ios::binary);
+    if(!out)
+        return -1;
+
+    // Lines are formatted into a buffer and written out in large blocks
+    vector<char> buffer;
+    jobRecord job;
+    long count = 0;
+    while(src.next(job)){
+        appendInt(buffer, job.id);
+        buffer.push_back(' ');
+        appendInt(buffer, job.arrivalTime);
+        buffer.push_back(' ');
+        appendInt(buffer, job.numBursts);
+        for(int i=0; i<job.numBursts; i++){
+            buffer.push_back(' ');
+            appendInt(buffer, job.bursts[i]);
+        }
+        buffer.push_back('\n');
+        count++;
+        if(buffer.size() >= (1 << 20)){
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    return out ? count : -1;
+}
+
+#endif // JOBSOURCE_H_INCLUDED
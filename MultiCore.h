@@ -0,0 +1,336 @@
+/**
+ * This file contains the MultiCoreCPU class. It is used to simulate a virtual CPU with several cores.
+ *
+ * Every core has its own ready queue. New jobs are spread over the cores round robin, and a job coming back from IO
+ * returns to the core it last ran on. A core that runs out of work steals the next job from the core with the longest
+ * ready queue, and a job queued on a busy core is taken by an idle core right away, so no core sits idle while a job
+ * waits. A job that runs on a different core than last time counts as a migration.
+ *
+ * The simulation is event driven: every core's next burst completion or quantum expiry, every IO completion and the
+ * arrival of the next job (if jobs are only admitted once they arrive) is kept in one min-heap, so the cost of an event
+ * is O(log n) whatever the number of cores.
+ *
+ * Requires PCB.h, stats.h, ReadyQueue.h, JobSource.h, ResultsWriter.h, IOSubsystem.h
+ */
+
+#ifndef MULTICORE_H_INCLUDED
+#define MULTICORE_H_INCLUDED
+
+#include "PCB.h"
+#include "ReadyQueue.h"
+#include "JobSource.h"
+#include "ResultsWriter.h"
+#include "IOSubsystem.h"
+#include <climits>
+#include <algorithm>
+#include <cstdio>
+
+#define EVENT_CORE 0
+#define EVENT_IO 1
+#define EVENT_ARRIVAL 2
+
+using namespace std;
+
+// Event of the multi-core simulation: a core finishing its current slice or a job finishing IO
+struct coreEvent{
+    unsigned long time, seq;
+    int type, id;           // id is the core for EVENT_CORE and the job's slot for EVENT_IO (unused for EVENT_ARRIVAL)
+};
+
+inline bool operator>(const coreEvent &a, const coreEvent &b){
+    return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+}
+
+// State of one core
+struct core{
+    ReadyQueue readyQ;
+    int running;                    // Slot of the job running on this core (-1 if idle)
+    int slice;                      // Units of time the running job was given
+    unsigned long sliceStart;       // Time the running job was dispatched
+    bool inIdleList;
+    unsigned long busyTime, dispatches, steals;
+};
+
+class MultiCoreCPU{
+private:
+    unsigned long CPUTime, seq, migrations;
+    int nCores, jobsInMemory, maxJobs, quantum, order, nextCore, jobsComplete;
+    int queuedJobs;                 // Jobs waiting in all the ready queues together
+    vector<core> cores;
+    PCBPool jobTable;               // PCBs of the jobs in memory, indexed by slot (same as in CPU.h)
+    vector<int> lastCore;           // Core each slot's job last ran on
+    vector<int> idleCores;          // Cores that may be idle (checked when taken off the list)
+    IOSubsystem IO;                 // IO devices (completions are scheduled in the event heap, not in IO)
+    priority_queue<coreEvent, vector<coreEvent>, greater<coreEvent> > events;
+    stats jobStats;
+    ResultsWriter *results;         // Where the row of every completed job is recorded (NULL if it isn't)
+    bool admitOnArrival;            // Are jobs only admitted once the clock reaches their arrival time?
+    bool hasPending, arrivalScheduled;
+    jobRecord pending;              // Next job of the job source, read but not admitted yet because it hasn't arrived
+    unsigned long stopTime;         // The simulation stops when the clock reaches this time
+
+    void schedule(unsigned long time, int type, int id);
+    bool admit(JobSource *jobQ);
+    void enqueue(int slot, int c);
+    void dispatch(int c, int victim);
+    void coreDone(int c);
+    void IODone(int slot);
+public:
+    MultiCoreCPU(int numCores, int memory, int io, int ord, int q);
+    void run(JobSource *jobQ);
+    unsigned long getCPUTime()  { return CPUTime; }         // Read the CPU time
+    stats &getStats()           { return jobStats; }        // Statistics of every job completed
+    void setResults(ResultsWriter *w)   { results = w; }    // Record the row of every completed job with a results writer (NULL to stop)
+    void setAdmitOnArrival(bool a)      { admitOnArrival = a; } // Choose whether jobs are only admitted once they have arrived
+    void setStopTime(unsigned long t)   { stopTime = t; }   // Stop the simulation when the clock reaches this time
+    IOSubsystem &getIO()        { return IO; }              // Get the IO devices (e.g. to set the number of devices before simulation)
+    void printCoreStats();
+};
+
+/* Class constructor
+ * @param: numCores - number of cores
+           memory - number of jobs that fit in memory at a time
+           io - time an IO operation takes. There is one IO device per core unless the IO devices are configured
+           ord - order jobs are picked from each ready queue (ORDER_FIFO or ORDER_SHORTEST, look at ReadyQueue.h)
+           q - time quantum after which the running job is preempted (INT_MAX for no preemption)
+*/
+MultiCoreCPU::MultiCoreCPU(int numCores, int memory, int io, int ord, int q){
+    CPUTime = 0;
+    seq = 0;
+    migrations = 0;
+    nCores = numCores;
+    jobsInMemory = 0;
+    maxJobs = memory;
+    quantum = q;
+    order = ord;
+    nextCore = 0;
+    jobsComplete = 0;
+    queuedJobs = 0;
+    results = NULL;
+    admitOnArrival = false;
+    hasPending = arrivalScheduled = false;
+    stopTime = ULONG_MAX;
+
+    cores.resize(nCores);
+    for(int c=0; c<nCores; c++){
+        cores[c].readyQ.setOrder(order);
+        cores[c].running = -1;
+        cores[c].slice = 0;
+        cores[c].sliceStart = 0;
+        cores[c].inIdleList = true;
+        cores[c].busyTime = cores[c].dispatches = cores[c].steals = 0;
+        idleCores.push_back(c);
+    }
+    IO.configure(vector<long>(nCores, io));
+    jobTable.reserve(max(memory, 0));
+    lastCore.reserve(max(memory, 0));
+}
+
+// Function to add an event to the event heap
+void MultiCoreCPU::schedule(unsigned long time, int type, int id){
+    coreEvent e = { time, seq++, type, id };
+    events.push(e);
+}
+
+/* Function to load the next job into memory and queue it on a core. Returns false if memory is full or there are no more jobs
+ * If jobs are admitted on arrival and the next job hasn't arrived yet, its arrival is added to the event heap instead
+ */
+bool MultiCoreCPU::admit(JobSource *jobQ){
+    jobRecord job;
+    if(admitOnArrival){
+        if(jobsInMemory == maxJobs)
+            return false;
+        if(!hasPending && !(hasPending = jobQ->next(pending)))
+            return false;
+        if(pending.arrivalTime > (long)CPUTime){
+            if(!arrivalScheduled)
+                schedule(pending.arrivalTime, EVENT_ARRIVAL, 0);
+            arrivalScheduled = true;
+            return false;
+        }
+        job = pending;
+        hasPending = arrivalScheduled = false;
+    }
+    else{
+        if(jobsInMemory == maxJobs || jobQ->done() || !jobQ->next(job))
+            return false;
+    }
+    int slot = jobTable.load(job.id, job.arrivalTime, job.numBursts, job.bursts);
+    if(slot == (int)lastCore.size())
+        lastCore.push_back(-1);
+    jobsInMemory++;
+
+    // New jobs are spread over the cores round robin
+    lastCore[slot] = -1;
+    enqueue(slot, nextCore);
+    nextCore = (nextCore + 1) % nCores;
+    return true;
+}
+
+// Function to queue a ready job on a core, and get it running at once if that core or any other core is idle
+void MultiCoreCPU::enqueue(int slot, int c){
+    PCB j = jobTable.get(slot);
+    j.setState(STATE_READY);
+    cores[c].readyQ.push(slot, order == ORDER_SHORTEST ? j.getThisBurst() : 0);
+    queuedJobs++;
+
+    if(cores[c].running < 0)
+        dispatch(c, c);
+    else{
+        // The core is busy, so let an idle core (if there is one) take the job instead
+        while(idleCores.size()){
+            int d = idleCores.back();
+            idleCores.pop_back();
+            cores[d].inIdleList = false;
+            if(cores[d].running < 0){
+                dispatch(d, c);
+                break;
+            }
+        }
+    }
+}
+
+/* Function to start the next job on an idle core
+ * The job is taken from the core's own ready queue or, if that is empty, stolen from the victim core
+ * (or from the core with the longest ready queue if the victim has nothing either)
+ */
+void MultiCoreCPU::dispatch(int c, int victim){
+    core *thisCore = &cores[c];
+    if(!thisCore->readyQ.size()){
+        // Only look for the longest ready queue if some core has a job waiting
+        if(cores[victim].readyQ.size() == 0){
+            victim = -1;
+            int longest = 0;
+            if(queuedJobs)
+                for(int v=0; v<nCores; v++)
+                    if(cores[v].readyQ.size() > longest){
+                        longest = cores[v].readyQ.size();
+                        victim = v;
+                    }
+        }
+        // Nothing to run or steal, so the core goes idle
+        if(victim < 0){
+            if(!thisCore->inIdleList){
+                thisCore->inIdleList = true;
+                idleCores.push_back(c);
+            }
+            return;
+        }
+    }
+    else
+        victim = c;
+
+    ReadyQueue &from = cores[victim].readyQ;
+    int slot = from.front();
+    from.pop();
+    queuedJobs--;
+    if(victim != c)
+        thisCore->steals++;
+    if(lastCore[slot] >= 0 && lastCore[slot] != c)
+        migrations++;
+    lastCore[slot] = c;
+
+    // Run until the burst completes or the quantum expires, whichever comes first
+    PCB j = jobTable.get(slot);
+    if(j.getStartTime() < 0)
+        j.setStartTime(CPUTime);
+    j.setState(STATE_RUN);
+    thisCore->running = slot;
+    thisCore->slice = min(j.getBurstRemaining(), quantum);
+    thisCore->sliceStart = CPUTime;
+    thisCore->dispatches++;
+    schedule(CPUTime + thisCore->slice, EVENT_CORE, c);
+}
+
+// Function to handle the end of the running job's slice on a core: the job completes, blocks for IO or is preempted
+void MultiCoreCPU::coreDone(int c){
+    int slot = cores[c].running;
+    PCB j = jobTable.get(slot);
+    j.incCurrentBurstPC(cores[c].slice);
+    cores[c].busyTime += cores[c].slice;
+    cores[c].running = -1;
+
+    if(j.getBurstRemaining() == 0){
+        // Was this the last burst? If yes, the job is complete and leaves memory
+        if(j.getCurrentBurstNum() == j.getNumBursts()){
+            j.shotComplete();
+            j.writeEndTime(CPUTime);
+            jobStats.addStats(j.getStats());
+            if(results)
+                results->record(j);
+            jobTable.release(slot);
+            jobsInMemory--;
+            jobsComplete++;
+        }
+        // Otherwise it performs IO on the device that is free first
+        else{
+            j.burstComplete();
+            long serviceTime;
+            unsigned long IOCompTime = IO.start(CPUTime, serviceTime);
+            j.setIOCompTime(IOCompTime);
+            j.addIOTime(serviceTime);
+            j.setState(STATE_IOB);
+            schedule(IOCompTime, EVENT_IO, slot);
+        }
+    }
+    // The quantum expired, back to the end of this core's ready queue
+    else{
+        j.resetQuantum();
+        j.shotComplete();
+        cores[c].readyQ.push(slot, order == ORDER_SHORTEST ? j.getThisBurst() : 0);
+        queuedJobs++;
+    }
+    dispatch(c, c);
+}
+
+// Function to bring a job back from IO to the core it last ran on
+void MultiCoreCPU::IODone(int slot){
+    enqueue(slot, lastCore[slot]);
+}
+
+// Function to run the simulation until every job from the job source is complete or the clock reaches the stop time
+void MultiCoreCPU::run(JobSource *jobQ){
+    while(admit(jobQ));
+    while(events.size()){
+        coreEvent e = events.top();
+        if(e.time >= stopTime){
+            // Slices cut off at the stop time only count as busy up to it
+            CPUTime = stopTime;
+            for(int c=0; c<nCores; c++)
+                if(cores[c].running >= 0)
+                    cores[c].busyTime += CPUTime - cores[c].sliceStart;
+            break;
+        }
+        events.pop();
+        CPUTime = e.time;
+        if(e.type == EVENT_CORE)
+            coreDone(e.id);
+        else if(e.type == EVENT_IO)
+            IODone(e.id);
+        else
+            arrivalScheduled = false;
+        // Jobs that completed made room in memory
+        while(admit(jobQ));
+    }
+}
+
+// Function to print the utilization of every core, the migrations and the load imbalance between cores
+void MultiCoreCPU::printCoreStats(){
+    unsigned long maxBusy = 0, totalBusy = 0, steals = 0;
+    printf("%-5s %12s %11s %12s %10s\n", "core", "busy_time", "utilization", "dispatches", "steals");
+    for(int c=0; c<nCores; c++){
+        core &k = cores[c];
+        printf("%-5d %12lu %10.2f%% %12lu %10lu\n", c, k.busyTime, CPUTime ? 100.0*k.busyTime/CPUTime : 0.0,
+               k.dispatches, k.steals);
+        maxBusy = max(maxBusy, k.busyTime);
+        totalBusy += k.busyTime;
+        steals += k.steals;
+    }
+    double meanBusy = (double)totalBusy/nCores;
+    printf("Average utilization = %.2f%%\n", CPUTime ? 100.0*meanBusy/CPUTime : 0.0);
+    printf("Steals = %lu\n", steals);
+    printf("Migrations = %lu\n", migrations);
+    printf("Load imbalance (busiest core / average) = %.3f\n", meanBusy ? maxBusy/meanBusy : 1.0);
+}
+
+#endif // MULTICORE_H_INCLUDED
@@ -0,0 +1,89 @@
+/**
+ * This file contains the Overhead class, the cost in CPU time of the work the operating system does between jobs.
+ * While the CPU pays overhead the clock runs and IO devices keep working, but no job makes progress, so short quanta
+ * and frequent IO cost throughput as they do on a real machine. No overhead is charged unless it is set up.
+ *
+ * Overhead is described by a spec of comma separated settings, e.g.
+ *      switch=const:5,dispatch=uniform:1:3,admit=20,io=exp:4,seed=7
+ *      switch   - context switch: a job other than the one that ran last is given the CPU
+ *      dispatch - a job is given the CPU (the start of every shot, whether or not it is a context switch)
+ *      admit    - a job is loaded into memory
+ *      io       - a job enters the kernel to start an IO operation
+ *      seed     - seed of the random number generator costs are drawn with (default 1)
+ * Each cost is a distribution, as in a workload spec (check Workload.h), or a number for a constant cost. Costs are
+ * never negative.
+ *
+ * Requires Workload.h
+ */
+
+#ifndef OVERHEAD_H_INCLUDED
+#define OVERHEAD_H_INCLUDED
+
+#include "Workload.h"
+#include <algorithm>
+
+#define OVERHEAD_SWITCH 0
+#define OVERHEAD_DISPATCH 1
+#define OVERHEAD_ADMIT 2
+#define OVERHEAD_IO 3
+#define OVERHEAD_KINDS 4
+
+using namespace std;
+
+class Overhead{
+private:
+    distribution costs[OVERHEAD_KINDS];
+    bool hasCost[OVERHEAD_KINDS];       // Is a cost set for each kind of overhead?
+    bool enabled;                       // Is any cost set?
+    Random rng;
+public:
+    Overhead();
+    bool setSpec(string spec);
+    bool any()                  { return enabled; }     // Is any overhead charged?
+    long cost(int kind)         { return hasCost[kind] ? max(0L, sample(costs[kind], rng)) : 0; }  // Draw the cost of one event of a kind
+    void save(SnapshotWriter &out)  { rng.save(out); }          // Write the state of the random number generator to a snapshot
+    bool load(SnapshotReader &in)   { return rng.load(in); }    // Read the state of the random number generator back from a snapshot
+};
+
+// Default class constructor (no overhead)
+Overhead::Overhead(){
+    for(int k=0; k<OVERHEAD_KINDS; k++)
+        hasCost[k] = false;
+    enabled = false;
+}
+
+/* Function to set up the costs from an overhead spec (kinds not in the spec cost nothing)
+ * Returns false if the spec is invalid
+ */
+bool Overhead::setSpec(string spec){
+    const char *names[OVERHEAD_KINDS] = { "switch", "dispatch", "admit", "io" };
+    unsigned long long seed = 1;
+    for(int k=0; k<OVERHEAD_KINDS; k++)
+        hasCost[k] = false;
+    enabled = false;
+
+    istringstream settings(spec);
+    string setting;
+    while(getline(settings, setting, ',')){
+        size_t eq = setting.find('=');
+        if(eq == string::npos)
+            return false;
+        string key = setting.substr(0, eq), value = setting.substr(eq + 1);
+        if(key == "seed"){
+            seed = strtoull(value.c_str(), NULL, 10);
+            continue;
+        }
+        int k = find(names, names + OVERHEAD_KINDS, key) - names;
+        if(k == OVERHEAD_KINDS)
+            return false;
+        if(value.find(':') == string::npos)     // A plain number is a constant cost
+            value = "const:" + value;
+        if(!parseDistribution(value, costs[k]))
+            return false;
+        hasCost[k] = enabled = true;
+    }
+    rng.setSeed(seed);
+    return true;
+}
+
+#endif // OVERHEAD_H_INCLUDED
@@ -1,6 +1,7 @@
 /**
  * Author : Prahar Ijner
- * This file contains the PCB (Program Control Block) class, which holds the details of a program in memory.
+ * This file contains the PCB (Program Control Block) class, which holds the details of a program in memory,
+ * and the PCBPool class the PCBs of all the programs in memory are stored in.
  *
  * Requires stats.h
  */
@@ -10,6 +11,8 @@
 
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cassert>
 #include "stats.h"
 
 #define STATE_READY 0
@@ -19,82 +22,273 @@
 
 using namespace std;
 
+class PCBPool;
+
+// Results of a completed job (what is printed and written to a results file for it)
+struct jobResult{
+    long id, arrival, start, end, processing, wait, turnaround, shots;
+};
+
+void printResult(const jobResult &r);
+
+/* Handle of a job in a PCBPool. It is only a pool pointer and an index, so it is as cheap to copy as an int,
+ * and every change made through any handle of a job is seen through all the others
+ */
 class PCB{
 private:
-    int jobID, state, PC, nBursts, cBurst, IOCompTime, startTime, endTime, arrivalTime, cBurstPC, quantumTime, numShots;
-    vector<int> burstList;
+    PCBPool *pool;
+    int slot;
 public:
-    PCB(int jID, int aTime, int nB, vector<int> bL);
-    int getID()                 { return jobID; }                       // Get the ID of this job
-    void setIOCompTime(int t)   { IOCompTime = t; }                     // Set the time at which IO operation will complete
-    int  getIOCompTime()        { return IOCompTime; }                  // Get the time at which IO operation will complete
-    void writeEndTime(int t)    { endTime = t; }                        // Write the time at which the process finished execution
-    int  getCurrentBurstNum()   { return cBurst; }                      // Get which burst this process is on
-    void setState(int s)        { state = s; }                          // Change running state of the process (look at defined constants for states)
-    int  getState()             { return state; }                       // Get the running state of the process
-    void setStartTime(int t)    { startTime = t; }                      // Write when this process received the first CPU cycle
-    int  getCurrentBurstPC()    { return cBurstPC; }                    // Get number of cycles current burst has received
-    void incCurrentBurstPC()    { cBurstPC++; PC++; quantumTime++; }    // Give this process 1 clock cycle (increases PC and number of cycles used in current quantum)
-    int  getThisBurst()         { return burstList.at(cBurst-1); }      // Get number of cycles current burst needs
-    int  getNumBursts()         { return nBursts; }                     // Get number of bursts this process has
-    void resetQuantum()         { quantumTime = 0; }                    // Reset number of cycles used in present quantum (used at the end of quantum or end of burst)
-    void shotComplete()         { numShots++; }                         // Increase the number of shots used by 1
+    PCB(PCBPool *p, int s)      { pool = p; slot = s; }
+    int  getSlot()              { return slot; }                        // Get the index of this job in its pool
+    int  getID();                                                       // Get the ID of this job
+    void setIOCompTime(long t);                                         // Set the time at which IO operation will complete
+    long getIOCompTime();                                               // Get the time at which IO operation will complete
+    void addIOTime(int t);                                              // Add the time an IO operation of this process takes (not counting waiting for the device)
+    void writeEndTime(long t);                                          // Write the time at which the process finished execution
+    int  getCurrentBurstNum();                                          // Get which burst this process is on
+    void setState(int s);                                               // Change running state of the process (look at defined constants for states)
+    int  getState();                                                    // Get the running state of the process
+    void setStartTime(long t);                                          // Write when this process received the first CPU cycle
+    long getStartTime();                                                // Get when this process received the first CPU cycle (-1 if it hasn't run yet)
+    long getArrivalTime();                                              // Get the time at which the process arrived
+    long getEndTime();                                                  // Get the time at which the process finished execution
+    int  getCurrentBurstPC();                                           // Get number of cycles current burst has received
+    void incCurrentBurstPC();                                           // Give this process 1 clock cycle (increases PC and number of cycles used in current quantum)
+    void incCurrentBurstPC(int n);                                      // Give this process n clock cycles at once (used by the event driven engine)
+    int  getThisBurst();                                                // Get number of cycles current burst needs
+    int  getBurstRemaining()    { return getThisBurst() - getCurrentBurstPC(); }    // Get number of cycles current burst still needs
+    int  getNumBursts();                                                // Get number of bursts this process has
+    void resetQuantum();                                                // Reset number of cycles used in present quantum (used at the end of quantum or end of burst)
+    void shotComplete();                                                // Increase the number of shots used by 1
     void printStats();
+    jobResult getResult();                                              // Get the results of the process (its end time must have been written)
     void burstComplete();
-    int  getCurrentQuantumTime(){ return quantumTime; }
+    int  getCurrentQuantumTime();
+    int  getLevel();                                                    // Get the queue level of the process (used by the multi-level feedback queue)
+    void setLevel(int l);                                               // Move the process to another queue level
     stats getStats();
 };
 
-// Class constructor to initialize PCB using details from JobQueue
-PCB::PCB(int jID, int aTime, int nB, vector<int> bL){
-    jobID = jID;
-    arrivalTime = aTime;
-    nBursts = nB;
-    burstList = bL;
+// Fields of one job in a PCBPool. The fields used at every event come first, so they share a cache line
+struct pcbRecord{
+    int state, PC, nBursts, cBurst, cBurstPC, quantumTime, numShots, level;
+    int thisBurst;                      // Length of the current burst (a copy of it, so it is read without the burst buffer)
+    int IOTime;
+    size_t burstStart;                  // Index of the job's first burst in the burst buffer
+    long startTime, IOCompTime;
+    long arrivalTime, endTime;
+    int jobID;
+};
+
+/* Pool of the PCBs of every job in memory, stored in one array with a record per job, so all the fields of a job are
+ * read together however many jobs are in memory
+ * The bursts of all the jobs are packed into one buffer. When it fills up, the bursts of the jobs still in memory are
+ * copied to the front of a second buffer and the two are swapped, so once the pool has grown to the size the
+ * simulation needs, loading and removing jobs never allocates memory
+ */
+class PCBPool{
+private:
+    vector<pcbRecord> jobs;
+    vector<int> bursts, spareBursts;    // Burst buffer and the buffer it is compacted into
+    size_t burstsUsed;
+    vector<int> freeSlots;
+    vector<char> inUse;
+    int jobsInPool;
+    void compact(size_t needed);
+    friend class PCB;
+public:
+    PCBPool()                   { burstsUsed = 0; jobsInPool = 0; }
+    int  size()                 { return jobsInPool; }                  // Return the number of jobs in the pool
+    int  slots()                { return jobs.size(); }                 // Return the number of slots (jobs in the pool + free slots)
+    PCB  get(int slot)          { return PCB(this, slot); }             // Get the job in a slot
+    void reserve(int n);
+    int  load(int jID, long aTime, int nB, const int *bL);
+    void release(int slot);
+    void save(SnapshotWriter &out);
+    bool load(SnapshotReader &in);
+};
+
+// Function to make room for a number of jobs, so that loading that many jobs won't allocate memory for their records
+void PCBPool::reserve(int n){
+    jobs.reserve(n);
+    freeSlots.reserve(n);
+    inUse.reserve(n);
+}
+
+/* Function to load a job into the pool, using details from JobQueue
+ * The job must have at least one burst (the job sources reject jobs without bursts, check JobSource.h)
+ * Returns the slot the job was loaded into. Slots of released jobs are reused first
+ */
+int PCBPool::load(int jID, long aTime, int nB, const int *bL){
+    assert(nB >= 1);
+    int slot;
+    if(freeSlots.size()){
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    else{
+        slot = jobs.size();
+        jobs.push_back(pcbRecord());
+        inUse.push_back(0);
+    }
+
+    // Copy the bursts to the end of the burst buffer
+    if(burstsUsed + nB > bursts.size())
+        compact(nB);
+    pcbRecord &j = jobs[slot];
+    j.burstStart = burstsUsed;
+    copy(bL, bL + nB, bursts.begin() + burstsUsed);
+    burstsUsed += nB;
+
+    j.jobID = jID;
+    j.arrivalTime = aTime;
+    j.nBursts = nB;
+    j.thisBurst = bL[0];
 
     // Initialize other data members to standard value
-    state = STATE_READY;
-    PC = 0;
-    cBurst = 1;
-    IOCompTime = 0;
-    cBurstPC= 0;
-    quantumTime = 0;
-    numShots = 0;
+    j.state = STATE_READY;
+    j.PC = 0;
+    j.IOTime = 0;
+    j.cBurst = 1;
+    j.IOCompTime = 0;
+    j.startTime = -1;
+    j.endTime = 0;
+    j.cBurstPC = 0;
+    j.quantumTime = 0;
+    j.numShots = 0;
+    j.level = 0;
+    inUse[slot] = 1;
+    jobsInPool++;
+    return slot;
 }
 
+// Function to remove a job from the pool. Its bursts are reclaimed the next time the burst buffer is compacted
+void PCBPool::release(int slot){
+    inUse[slot] = 0;
+    freeSlots.push_back(slot);
+    jobsInPool--;
+}
+
+/* Function to move the bursts of the jobs in the pool to the front of the burst buffer, to make room for needed more
+ * If that doesn't free at least half of the buffer, both buffers are doubled so compaction stays rare
+ */
+void PCBPool::compact(size_t needed){
+    size_t live = 0;
+    for(size_t s=0; s<jobs.size(); s++)
+        if(inUse[s])
+            live += jobs[s].nBursts;
+    if(spareBursts.size() < bursts.size())
+        spareBursts.resize(bursts.size());
+    if(2*(live + needed) > bursts.size()){
+        size_t newSize = max(2*(live + needed), (size_t)1024);
+        spareBursts.resize(newSize);
+        bursts.resize(newSize);
+    }
+
+    size_t used = 0;
+    for(size_t s=0; s<jobs.size(); s++)
+        if(inUse[s]){
+            pcbRecord &j = jobs[s];
+            copy(bursts.begin() + j.burstStart, bursts.begin() + j.burstStart + j.nBursts, spareBursts.begin() + used);
+            j.burstStart = used;
+            used += j.nBursts;
+        }
+    bursts.swap(spareBursts);
+    burstsUsed = used;
+}
+
+// Function to write every job in the pool to a snapshot (the bursts are compacted first, so only live bursts are written)
+void PCBPool::save(SnapshotWriter &out){
+    compact(0);
+    out.putVector(jobs);
+    out.putVector(freeSlots);
+    out.putVector(inUse);
+    out.put(jobsInPool);
+    out.putVector(vector<int>(bursts.begin(), bursts.begin() + burstsUsed));
+}
+
+// Function to replace the jobs in the pool with the jobs of a snapshot. Returns false if the snapshot ended
+bool PCBPool::load(SnapshotReader &in){
+    in.getVector(jobs);
+    in.getVector(freeSlots);
+    in.getVector(inUse);
+    in.get(jobsInPool);
+    in.getVector(bursts);
+    burstsUsed = bursts.size();
+    spareBursts.clear();
+    return in.good();
+}
+
+inline int  PCB::getID()                        { return pool->jobs[slot].jobID; }
+inline void PCB::setIOCompTime(long t)          { pool->jobs[slot].IOCompTime = t; }
+inline long PCB::getIOCompTime()                { return pool->jobs[slot].IOCompTime; }
+inline void PCB::addIOTime(int t)               { pool->jobs[slot].IOTime += t; }
+inline void PCB::writeEndTime(long t)           { pool->jobs[slot].endTime = t; }
+inline int  PCB::getCurrentBurstNum()           { return pool->jobs[slot].cBurst; }
+inline void PCB::setState(int s)                { pool->jobs[slot].state = s; }
+inline int  PCB::getState()                     { return pool->jobs[slot].state; }
+inline void PCB::setStartTime(long t)           { pool->jobs[slot].startTime = t; }
+inline long PCB::getStartTime()                 { return pool->jobs[slot].startTime; }
+inline long PCB::getArrivalTime()               { return pool->jobs[slot].arrivalTime; }
+inline long PCB::getEndTime()                   { return pool->jobs[slot].endTime; }
+inline int  PCB::getCurrentBurstPC()            { return pool->jobs[slot].cBurstPC; }
+inline void PCB::incCurrentBurstPC()            { pcbRecord &j = pool->jobs[slot]; j.cBurstPC++; j.PC++; j.quantumTime++; }
+inline void PCB::incCurrentBurstPC(int n)       { pcbRecord &j = pool->jobs[slot]; j.cBurstPC += n; j.PC += n; j.quantumTime += n; }
+inline int  PCB::getThisBurst()                 { return pool->jobs[slot].thisBurst; }
+inline int  PCB::getNumBursts()                 { return pool->jobs[slot].nBursts; }
+inline void PCB::resetQuantum()                 { pool->jobs[slot].quantumTime = 0; }
+inline void PCB::shotComplete()                 { pool->jobs[slot].numShots++; }
+inline int  PCB::getCurrentQuantumTime()        { return pool->jobs[slot].quantumTime; }
+inline int  PCB::getLevel()                     { return pool->jobs[slot].level; }
+inline void PCB::setLevel(int l)                { pool->jobs[slot].level = l; }
+
 // Function to return stats of the current process (used at the end of every process)
 stats PCB::getStats(){
-    int processingTime = PC+IO_TIME*(nBursts-1);        // Processing time = time spent on CPU + 10*Number of IO operations
-    int tat = endTime - arrivalTime;                    // Turn around time = end time - arrival time
-    int waitTime = tat - processingTime;                // waiting time = turn around time - processing time
-    stats s(processingTime, waitTime, tat, numShots );
+    pcbRecord &j = pool->jobs[slot];
+    long processingTime = j.PC+j.IOTime;                // Processing time = time spent on CPU + time spent performing IO
+    long tat = j.endTime - j.arrivalTime;               // Turn around time = end time - arrival time
+    long waitTime = tat - processingTime;               // waiting time = turn around time - processing time
+    stats s(processingTime, waitTime, tat, j.numShots );
 
     return s;
 }
 
+// Function to collect the results of the process (used at the end of every process)
+jobResult PCB::getResult(){
+    pcbRecord &j = pool->jobs[slot];
+    long processingTime = j.PC+j.IOTime;
+    long tat = j.endTime - j.arrivalTime;
+    jobResult r = { j.jobID, j.arrivalTime, j.startTime, j.endTime, processingTime, tat - processingTime, tat, j.numShots };
+    return r;
+}
+
 // Function to print the stats of the process (used at the end of every process)
 void PCB::printStats(){
-    cout << "ID: " << jobID << endl;
-    cout << "Arrived at " << arrivalTime << endl;
-    cout << "Completed at " << endTime << endl;
-    cout << "Processing time " << PC+IO_TIME*(nBursts-1) << endl;
-    int tat = endTime - arrivalTime;
-    cout << "Waiting time " << tat - (PC+IO_TIME*(nBursts-1)) << endl;
-    cout << "Turn around time " << tat << endl;
-    cout << "CPU shots used " << numShots << endl << endl;
+    printResult(getResult());
+}
+
+// Function to print the results of a completed job
+void printResult(const jobResult &r){
+    cout << "ID: " << r.id << "\n";
+    cout << "Arrived at " << r.arrival << "\n";
+    cout << "Completed at " << r.end << "\n";
+    cout << "Processing time " << r.processing << "\n";
+    cout << "Waiting time " << r.wait << "\n";
+    cout << "Turn around time " << r.turnaround << "\n";
+    cout << "CPU shots used " << r.shots << "\n\n";
 }
 
 // Function to signal the current burst has been completed
 void PCB::burstComplete(){
-    cBurst++;               // Increment current burst value to next burst
-    numShots++;             // Increment number of CPU shots used
-    state = STATE_IOB;      // Change state to blocking for IO
-    cBurstPC = 0;           // Reset number of cycles consumed in current burst
-    quantumTime = 0;        // Reset number of cycles used in current quantum burst
+    pcbRecord &j = pool->jobs[slot];
+    j.cBurst++;                     // Increment current burst value to next burst
+    j.numShots++;                   // Increment number of CPU shots used
+    j.state = STATE_IOB;            // Change state to blocking for IO
+    j.cBurstPC = 0;                 // Reset number of cycles consumed in current burst
+    j.quantumTime = 0;              // Reset number of cycles used in current quantum burst
+    if(j.cBurst <= j.nBursts)       // Length of the next burst
+        j.thisBurst = pool->bursts[j.burstStart + j.cBurst - 1];
 }
 
-// Comparison function to sort the processes based on the time for current burst. (Used for SJF)
-bool isBurstGreaterThan(PCB a, PCB b){
-    return (a.getThisBurst() < b.getThisBurst()) ;
-}
 #endif // PCB_H_INCLUDED
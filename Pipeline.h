@@ -0,0 +1,154 @@
+/**
+ * This file contains the Pipeline class. It runs a simulation as three threads, so reading the jobs and reporting the
+ * results overlap with the simulation instead of taking turns with it:
+ *      parser    - reads jobs from the job source (parsing text or generating them) and passes them on through a ring
+ *      simulator - the thread that created the pipeline. It runs the scheduling loop, reading the jobs from the ring
+ *                  (look at jobs()) and passing the completed jobs and CPU states to print through a second ring
+ *      reporter  - prints the completed jobs and CPU states in the order they happened, and records the completed
+ *                  jobs with the CPU's results writer
+ * Both rings are lock-free single producer, single consumer rings (look at SPSCRing.h). The output is the same as
+ * without the pipeline.
+ *
+ * Jobs are passed as ints: ID, arrival time (two ints, low then high half), number of bursts and the bursts.
+ * If the scheduling loop stops early (e.g. at the stop time), the parser stops once the ring is full. A parser blocked
+ * reading standard input only notices when more input arrives or the input ends.
+ *
+ * Requires CPU.h, JobSource.h, SPSCRing.h
+ */
+
+#ifndef PIPELINE_H_INCLUDED
+#define PIPELINE_H_INCLUDED
+
+#include "CPU.h"
+#include "SPSCRing.h"
+#include <thread>
+
+#define PIPE_JOB_RING (1 << 20)         // Ints in the ring of jobs
+#define PIPE_REPORT_RING (1 << 14)      // Records in the ring of completed jobs and CPU states
+#define PIPE_BATCH 4096                 // Ints passed to or taken from the ring of jobs at a time
+
+using namespace std;
+
+// Job source reading the jobs the parser thread passes through a ring
+class RingJobSource : public JobSource{
+private:
+    SPSCRing<int> &ring;
+    vector<int> chunk;          // Ints taken from the ring and not read yet
+    size_t pos, len;
+    vector<int> bursts;         // Bursts of the last job read (reused for every job)
+    bool isEndless;
+    bool fill();
+    int  word()                 { return (pos < len || fill()) ? chunk[pos++] : 0; }
+public:
+    RingJobSource(SPSCRing<int> &r, bool e) : ring(r)  { chunk.resize(PIPE_BATCH); pos = len = 0; isEndless = e; }
+    bool done()                 { return pos >= len && !fill(); }
+    bool next(jobRecord &job);
+    bool endless()              { return isEndless; }
+};
+
+// Function to take the next ints from the ring, waiting for the parser if needed. Returns false once there are no more jobs
+bool RingJobSource::fill(){
+    len = ring.popSome(chunk.data(), chunk.size());
+    pos = 0;
+    return len > 0;
+}
+
+// Function to read the next job
+bool RingJobSource::next(jobRecord &job){
+    if(done())
+        return false;
+    job.id = word();
+    unsigned long low = (unsigned int)word();
+    unsigned long high = (unsigned int)word();
+    job.arrivalTime = (long)(low | high << 32);
+    job.numBursts = word();
+    bursts.resize(job.numBursts);
+    for(int i=0; i<job.numBursts; i++)
+        bursts[i] = word();
+    job.bursts = bursts.data();
+    return true;
+}
+
+class Pipeline{
+private:
+    JobSource &source;
+    CPU &cpu;
+    SPSCRing<int> jobRing;
+    SPSCRing<reportRecord> reportRing;
+    RingJobSource ringJobs;
+    thread parser, reporter;
+    bool finished;
+    void parse();
+    void report();
+public:
+    Pipeline(JobSource &src, CPU &c);
+    ~Pipeline()                 { finish(); }
+    JobSource &jobs()           { return ringJobs; }    // Get the source the scheduling loop reads the jobs from
+    void finish();
+};
+
+// Class constructor (starts the parser reading src and the reporter reporting for the CPU c)
+Pipeline::Pipeline(JobSource &src, CPU &c) : source(src), cpu(c), jobRing(PIPE_JOB_RING), reportRing(PIPE_REPORT_RING),
+                                             ringJobs(jobRing, src.endless()){
+    finished = false;
+    cpu.setReports(&reportRing);
+    parser = thread(&Pipeline::parse, this);
+    reporter = thread(&Pipeline::report, this);
+}
+
+// Function run by the parser thread: pass every job of the source through the ring, in batches
+void Pipeline::parse(){
+    vector<int> batch;
+    batch.reserve(2*PIPE_BATCH);
+    jobRecord job;
+    while(source.next(job)){
+        unsigned long arrival = job.arrivalTime;
+        batch.push_back(job.id);
+        batch.push_back((int)(arrival & 0xffffffffUL));
+        batch.push_back((int)(arrival >> 32));
+        batch.push_back(job.numBursts);
+        batch.insert(batch.end(), job.bursts, job.bursts + job.numBursts);
+        if(batch.size() >= PIPE_BATCH){
+            if(!jobRing.pushAll(batch.data(), batch.size()))
+                return;         // The scheduling loop stopped reading
+            batch.clear();
+        }
+    }
+    jobRing.pushAll(batch.data(), batch.size());
+    jobRing.close();
+}
+
+// Function run by the reporter thread: print and record everything the CPU reports, until the CPU is done
+void Pipeline::report(){
+    vector<reportRecord> records(256);
+    bool verbose = cpu.isVerbose();
+    ResultsWriter *results = cpu.getResults();
+    size_t n;
+    while((n = reportRing.popSome(records.data(), records.size())) > 0)
+        for(size_t i=0; i<n; i++){
+            reportRecord &r = records[i];
+            if(r.kind == REPORT_STATE)
+                printState(r.ready, r.blocked, r.completed);
+            else{
+                if(verbose)
+                    printResult(r.job);
+                if(results)
+                    results->record(r.job);
+            }
+        }
+}
+
+// Function to wait for the parser and the reporter to finish, once the scheduling loop is done
+void Pipeline::finish(){
+    if(finished)
+        return;
+    finished = true;
+    cpu.flushReports();
+    cpu.setReports(NULL);
+    reportRing.close();
+    jobRing.cancel();           // The parser stops if it is still reading jobs
+    parser.join();
+    reporter.join();
+}
+
+#endif // PIPELINE_H_INCLUDED
@@ -0,0 +1,136 @@
+/**
+ * This file contains the ReadyQueue class. It holds the jobs that are ready to run, as indices into the CPU's job table.
+ *
+ * Jobs leave the queue either first come first serve (ORDER_FIFO) or smallest key first, where the key is the current
+ * burst (ORDER_SHORTEST), the remaining time of the current burst (ORDER_REMAINING), the queue level of a multi-level
+ * feedback queue (ORDER_LEVEL) or the aged priority (ORDER_PRIORITY, look at CPU::readyKey()). The CPU computes the key
+ * when the job is inserted. Keyed orders are kept in a binary heap, so inserting or removing a job is O(log n) and no
+ * PCB is ever moved or copied. Jobs with equal keys leave in the order they entered the queue.
+ */
+
+#ifndef READYQUEUE_H_INCLUDED
+#define READYQUEUE_H_INCLUDED
+
+#include <queue>
+#include <vector>
+#include <functional>
+#include <climits>
+#include "Snapshot.h"
+
+#define ORDER_FIFO 0
+#define ORDER_SHORTEST 1
+#define ORDER_REMAINING 2
+#define ORDER_LEVEL 3
+#define ORDER_PRIORITY 4
+
+using namespace std;
+
+// Entry of the heap. Jobs are ordered by key and, if the keys are equal, by the order in which they were inserted
+struct readyEntry{
+    long key;
+    unsigned long seq;
+    int slot;
+};
+
+inline bool operator>(const readyEntry &a, const readyEntry &b){
+    return a.key > b.key || (a.key == b.key && a.seq > b.seq);
+}
+
+class ReadyQueue{
+private:
+    int order, head;            // head is the job at the front of the queue once it has been picked (-1 if not picked yet)
+    unsigned long seq;
+    queue<int> fifo;
+    priority_queue<readyEntry, vector<readyEntry>, greater<readyEntry> > heap;
+public:
+    ReadyQueue(){
+        // Default class constructor
+        order = ORDER_FIFO;
+        head = -1;
+        seq = 0;
+    }
+    void setOrder(int o)        { order = o; }                                      // Choose the order jobs leave the queue in (only when it is empty)
+    int  getOrder()             { return order; }                                   // Read the order jobs leave the queue in
+    int  size()                 { return (head >= 0) + fifo.size() + heap.size(); } // Return the number of jobs in the queue
+    long nextKey()              { return heap.size() ? heap.top().key : LONG_MAX; } // Read the smallest key of the jobs behind the front job (LONG_MAX if there are none)
+    void push(int slot, long key);
+    int  front();
+    void pop();
+    vector<int> drain();
+    void save(SnapshotWriter &out);
+    bool load(SnapshotReader &in);
+};
+
+// Function to insert a job at the back of the queue. The key (e.g. the burst length) is only used by ORDER_SHORTEST
+void ReadyQueue::push(int slot, long key){
+    if(order == ORDER_FIFO)
+        fifo.push(slot);
+    else{
+        readyEntry e = { key, seq++, slot };
+        heap.push(e);
+    }
+}
+
+/* Function to get the job at the front of the queue
+ * Once picked, the front job stays at the front until pop() is called, even if a job with a smaller key is inserted
+ * (the job that is running can't be overtaken by a job that arrives while it runs)
+ */
+int ReadyQueue::front(){
+    if(head < 0){
+        if(order == ORDER_FIFO){
+            head = fifo.front();
+            fifo.pop();
+        }
+        else{
+            head = heap.top().slot;
+            heap.pop();
+        }
+    }
+    return head;
+}
+
+// Function to remove the job at the front of the queue
+void ReadyQueue::pop(){
+    front();
+    head = -1;
+}
+
+// Function to remove every job from the queue and return them in the order they would have left it (e.g. to insert them again in a different order)
+vector<int> ReadyQueue::drain(){
+    vector<int> slots;
+    while(size()){
+        slots.push_back(front());
+        pop();
+    }
+    return slots;
+}
+
+// Function to write the queue to a snapshot
+void ReadyQueue::save(SnapshotWriter &out){
+    out.put(order); out.put(head); out.put(seq);
+    vector<int> fifoSlots;
+    for(queue<int> q = fifo; q.size(); q.pop())
+        fifoSlots.push_back(q.front());
+    vector<readyEntry> entries;
+    for(priority_queue<readyEntry, vector<readyEntry>, greater<readyEntry> > h = heap; h.size(); h.pop())
+        entries.push_back(h.top());
+    out.putVector(fifoSlots);
+    out.putVector(entries);
+}
+
+// Function to replace the queue with the queue of a snapshot. Returns false if the snapshot ended
+bool ReadyQueue::load(SnapshotReader &in){
+    vector<int> fifoSlots;
+    vector<readyEntry> entries;
+    if(!(in.get(order) && in.get(head) && in.get(seq) && in.getVector(fifoSlots) && in.getVector(entries)))
+        return false;
+    fifo = queue<int>();
+    heap = priority_queue<readyEntry, vector<readyEntry>, greater<readyEntry> >();
+    for(size_t i=0; i<fifoSlots.size(); i++)
+        fifo.push(fifoSlots[i]);
+    for(size_t i=0; i<entries.size(); i++)
+        heap.push(entries[i]);
+    return true;
+}
+
+#endif // READYQUEUE_H_INCLUDED
@@ -0,0 +1,327 @@
+/**
+ * This file contains the reference implementation of the simulator: the original tick by tick FCFS, SJF and RR loops,
+ * with the original CPU and PCB classes (a queue of PCBs copied in and out, the ready queue sorted for SJF, one IO
+ * device). It is kept frozen as an oracle for the validation harness (validate.cpp), so the optimized engines can be
+ * checked against the behaviour they replaced. Do not optimize or change it.
+ *
+ * It differs from the original only where needed to run over any trace: jobs are read from a JobSource instead of
+ * lines of text, times are longs instead of ints, the memory size and IO time are parameters instead of constants, and
+ * every completed job is recorded instead of printed. SJF also sorts the ready queue with a stable sort: the original
+ * std::sort left the order of jobs with equal bursts to the standard library (libstdc++ only keeps it for up to 16 jobs),
+ * while the engines run them in the order they became ready.
+ *
+ * Requires PCB.h (for jobResult), JobSource.h
+ */
+
+#ifndef REFERENCE_H_INCLUDED
+#define REFERENCE_H_INCLUDED
+
+#include "PCB.h"
+#include "JobSource.h"
+#include <queue>
+#include <algorithm>
+
+using namespace std;
+
+// The original PCB class
+class RefPCB{
+private:
+    long jobID, state, PC, nBursts, cBurst, IOCompTime, startTime, endTime, arrivalTime, cBurstPC, quantumTime, numShots;
+    long ioTime;
+    vector<int> burstList;
+public:
+    RefPCB(long jID, long aTime, long nB, vector<int> bL, long io);
+    void setIOCompTime(long t)  { IOCompTime = t; }                     // Set the time at which IO operation will complete
+    long getIOCompTime()        { return IOCompTime; }                  // Get the time at which IO operation will complete
+    void writeEndTime(long t)   { endTime = t; }                        // Write the time at which the process finished execution
+    long getCurrentBurstNum()   { return cBurst; }                      // Get which burst this process is on
+    void setState(long s)       { state = s; }                          // Change running state of the process
+    long getState()             { return state; }                       // Get the running state of the process
+    void setStartTime(long t)   { startTime = t; }                      // Write when this process received the first CPU cycle
+    long getCurrentBurstPC()    { return cBurstPC; }                    // Get number of cycles current burst has received
+    void incCurrentBurstPC()    { cBurstPC++; PC++; quantumTime++; }    // Give this process 1 clock cycle
+    long getThisBurst()         { return burstList.at(cBurst-1); }      // Get number of cycles current burst needs
+    long getNumBursts()         { return nBursts; }                     // Get number of bursts this process has
+    void resetQuantum()         { quantumTime = 0; }                    // Reset number of cycles used in present quantum
+    void shotComplete()         { numShots++; }                         // Increase the number of shots used by 1
+    long getCurrentQuantumTime(){ return quantumTime; }
+    void burstComplete();
+    jobResult getResult();
+};
+
+// Class constructor to initialize PCB using details from JobQueue
+RefPCB::RefPCB(long jID, long aTime, long nB, vector<int> bL, long io){
+    jobID = jID;
+    arrivalTime = aTime;
+    nBursts = nB;
+    burstList = bL;
+    ioTime = io;
+
+    // Initialize other data members to standard value
+    state = STATE_READY;
+    PC = 0;
+    cBurst = 1;
+    IOCompTime = 0;
+    startTime = -1;
+    endTime = 0;
+    cBurstPC= 0;
+    quantumTime = 0;
+    numShots = 0;
+}
+
+// Function to return the results of the process (used at the end of every process)
+jobResult RefPCB::getResult(){
+    long processingTime = PC+ioTime*(nBursts-1);        // Processing time = time spent on CPU + IO time * Number of IO operations
+    long tat = endTime - arrivalTime;                   // Turn around time = end time - arrival time
+    jobResult r = { jobID, arrivalTime, startTime, endTime, processingTime, tat - processingTime, tat, numShots };
+    return r;
+}
+
+// Function to signal the current burst has been completed
+void RefPCB::burstComplete(){
+    cBurst++;               // Increment current burst value to next burst
+    numShots++;             // Increment number of CPU shots used
+    state = STATE_IOB;      // Change state to blocking for IO
+    cBurstPC = 0;           // Reset number of cycles consumed in current burst
+    quantumTime = 0;        // Reset number of cycles used in current quantum burst
+}
+
+// Comparison function to sort the processes based on the time for current burst. (Used for SJF)
+bool isRefBurstGreaterThan(RefPCB a, RefPCB b){
+    return (a.getThisBurst() < b.getThisBurst()) ;
+}
+
+// The original CPU class
+class RefCPU{
+private:
+    unsigned long CPUTime;
+    long jobsInMemory, totalWait, quantum, jobsComplete, maxJobs, ioTime;
+    queue<RefPCB> readyQ, IOBlockeQ;
+public:
+    RefCPU(long memory, long io){
+        CPUTime = 0;
+        jobsInMemory = 0;
+        totalWait = 0;
+        jobsComplete = 0;
+        quantum = 0;
+        maxJobs = memory;
+        ioTime = io;
+    }
+    unsigned long getCPUTime()  { return CPUTime; }         // Read the CPU time
+    long memoryUsed()           { return jobsInMemory; }    // Return the number of jobs in memory
+    long readyJobs()            { return readyQ.size(); }   // Return the number of jobs in ready queue
+    long getQuantum()           { return quantum; }         // Read the value of time quantum set for this CPU
+    RefPCB getCurrentJob()      { return readyQ.front(); }  // Get the job that is being or will begin executing
+    bool writeQuantum(long q);
+    void incCPUTime();
+    bool insertToReady(JobSource *jobQ);
+    void insertToIOBlock(RefPCB jobToInsert);
+    void serviceJob();
+    void startJob();
+    jobResult completeJob();
+    bool sortReadyQ();
+    void preemptJob();
+};
+
+// Function to store value of time quantum for preemption of jobs
+bool RefCPU::writeQuantum(long q){
+    if(q<=0)            // Can't have non-positive time quantum
+        return false;
+    quantum = q;
+    return true;
+}
+
+/* Function to add a job from job queue to the ready queue is possible
+ * Returns false if job can't be added to the queue
+ */
+bool RefCPU::insertToReady(JobSource *jobQ){
+    // If memory is full or there are no more jobs in the job queue, return false
+    if( jobsInMemory == maxJobs || jobQ->done() )
+        return false;
+
+    jobRecord job = jobRecord();
+    if(!jobQ->next(job))    // A malformed job ends the job queue
+        return false;
+    vector<int> bursts(job.bursts, job.bursts + job.numBursts);
+
+    // Create a PCB for the job just read from the job queue
+    RefPCB pcb(job.id, job.arrivalTime, job.numBursts, bursts, ioTime);
+    // Add this new job to the ready queue and increment number of jobs in memory
+    readyQ.push(pcb);
+    jobsInMemory++;
+
+    return true;
+}
+
+/* Function to increment CPU time by 1. It also checks if any job in the IO blocked queue has finished IO
+ * and brings it back to the ready queue if it has
+ */
+void RefCPU::incCPUTime(){
+    // If there's anything in the IO queue, did it just complete IO?
+    if(IOBlockeQ.size()){
+        RefPCB j = IOBlockeQ.front();
+        if(j.getIOCompTime() == (long)CPUTime){
+            // If it completed IO, set it's state to ready and move it to the ready queue
+            j.setState(STATE_READY);
+            readyQ.push(j);
+            IOBlockeQ.pop();
+        }
+    }
+    // Increment CPU time
+    CPUTime++;
+}
+
+/* Function to insert a job into the IO Blocked queue
+ * It checks if there are any jobs in the IO Blocked queue and accordingly decides when this process will finish IO
+ * NOTE : Only one job can perform IO at a given time
+ */
+void RefCPU::insertToIOBlock(RefPCB jobToInsert){
+    // process enters into IO only after burst is complete. So signal that first
+    jobToInsert.burstComplete();
+
+    // If there are any jobs in the IO Queue, the job being queued has to wait for those to finish IO before it can perform IO
+    if(IOBlockeQ.size()){
+        RefPCB j = IOBlockeQ.front();
+        // Total waiting time for IO = time for all jobs in IO queue to finish IO
+        long IOwaitTime = (j.getIOCompTime() - CPUTime) + (IOBlockeQ.size() - 1)*ioTime;
+        totalWait += IOwaitTime;
+        jobToInsert.setIOCompTime(CPUTime + IOwaitTime + ioTime);
+    }
+    // If there are no jobs in IO queue, this job can right away perform IO
+    else
+        jobToInsert.setIOCompTime(CPUTime + ioTime);
+
+    // Insert into the IO Blocked queue and remove from the ready queue
+    jobToInsert.setState(STATE_IOB);
+    IOBlockeQ.push(jobToInsert);
+    readyQ.pop();
+}
+
+// Function to run the first job in the ready queue for 1 unit of time
+void RefCPU::serviceJob(){
+    RefPCB *currentJob = &(readyQ.front());
+    currentJob->setState(STATE_RUN);
+    currentJob->incCurrentBurstPC();
+}
+
+// Function to initialize start time of a job if it is being run for the first time
+void RefCPU::startJob(){
+    RefPCB *currentJob = &(readyQ.front());
+    currentJob->setStartTime(CPUTime);
+    currentJob->setState(STATE_RUN);
+}
+
+// Function to mark a job as complete and return its results
+jobResult RefCPU::completeJob(){
+    RefPCB j = readyQ.front();
+    j.shotComplete();
+    j.writeEndTime(CPUTime);
+
+    readyQ.pop();               // Remove this from the ready queue
+    jobsInMemory--;             // Decrease number of jobs in memory by 1
+    jobsComplete++;             // Increase the number of jobs completed
+
+    return j.getResult();
+}
+
+// Function to sort the ready queue based on the shortest processing time of current burst (used in SJF)
+bool RefCPU::sortReadyQ(){
+    if (!readyQ.size())
+        return false;
+
+    // Empty the queue into a vector that can be sorted
+    vector<RefPCB> tempVec;
+    while(readyQ.size()){
+        tempVec.push_back(readyQ.front());
+        readyQ.pop();
+    }
+    // Sort the vector based on the processing time of burst
+    stable_sort(tempVec.begin(), tempVec.end(), isRefBurstGreaterThan);
+    // Add the sorted list back to the ready queue
+    while(tempVec.size()){
+        readyQ.push(tempVec.at(0));
+        tempVec.erase(tempVec.begin());
+    }
+    return true;
+}
+
+// Function to preempt the first job in the ready queue (used when time quantum expires)
+void RefCPU::preemptJob(){
+    if(readyQ.size()){
+        RefPCB *j = &(readyQ.front());
+        j->setState(STATE_READY);       // Set state to ready
+        j->resetQuantum();              // Reset the time quantum as it will start from 0 in the next quantum burst
+        j->shotComplete();              // Signal the shot has been completed
+
+        readyQ.push(readyQ.front());    // Add this to the end of the ready queue
+        readyQ.pop();                   // Remove it from the front of the ready queue
+    }
+}
+
+/**
+ * referenceRun - Simulates FCFS, SJF or RR (with the given quantum) the way the original loops did, one unit of time at a time
+ * @param: JobQ - source the jobs are read from as they are loaded into memory
+           memory - number of jobs that fit in memory at a time
+           ioTime - time an IO operation takes on the one IO device
+           completed - the results of every job are added to it, in the order the jobs complete
+ * Returns the clock at the end of simulation, or 0 if the policy or quantum is invalid
+*/
+unsigned long referenceRun(string policy, long quantum, JobSource &JobQ, long memory, long ioTime, vector<jobResult> &completed){
+    RefCPU myCPU(memory, ioTime);
+    bool sjf = policy == "SJF", rr = policy == "RR";
+    if(!sjf && !rr && policy != "FCFS")
+        return 0;
+    if(rr && !myCPU.writeQuantum(quantum))      // Time quantum must be a positive integer
+        return 0;
+
+    // We need to run the CPU as long as there are pending jobs in the queue or memory
+    while(myCPU.memoryUsed() || !JobQ.done()){
+        // Insert jobs into the ready queue if memory permits
+        while(myCPU.insertToReady(&JobQ));
+
+        // If all jobs in memory are waiting for IO
+        if(!myCPU.readyJobs()){
+            myCPU.incCPUTime();
+            continue;
+        }
+
+        // If a job has finished running, find the next shortest job and execute it
+        if(sjf && myCPU.getCurrentJob().getState() == STATE_READY)
+            myCPU.sortReadyQ();
+
+        RefPCB currentJob = myCPU.getCurrentJob();
+        // Is this is first burst of CPU the job is receiving?
+        if(currentJob.getCurrentBurstNum() == 0){
+            myCPU.startJob();
+            myCPU.serviceJob();
+        }
+
+        // If this burst cycle is complete
+        else if(currentJob.getCurrentBurstPC() == currentJob.getThisBurst()){
+
+            // Was this the last burst cycle? If yes, the process is complete
+            if(currentJob.getCurrentBurstNum() == currentJob.getNumBursts())
+                completed.push_back(myCPU.completeJob());
+
+            // The process is blocking for IO
+            else
+                myCPU.insertToIOBlock(currentJob);
+            continue;
+        }
+
+        // If the time quantum expired, preempt this job, add it to the end of the ready queue
+        else if(rr && currentJob.getCurrentQuantumTime() == myCPU.getQuantum()){
+            myCPU.preemptJob();
+            continue;
+        }
+        // This burst cycle isn't complete, so continue processing it
+        else
+            myCPU.serviceJob();
+
+        // Increment CPU clock by 1 and check if any jobs finished IO
+        myCPU.incCPUTime();
+    }
+    return myCPU.getCPUTime();
+}
+
+#endif // REFERENCE_H_INCLUDED
@@ -0,0 +1,130 @@
+/**
+ * This file contains the ResultsWriter class. It writes one row per completed job to a results file:
+ *      id, arrival, start, end, processing, wait, turnaround, shots
+ *
+ * Rows are collected in a large buffer and written to the file in big blocks, so recording a job costs about as much
+ * as formatting its numbers and the simulation never waits on a write for each job. Two formats are available:
+ *      csv    - a header line followed by one line per job
+ *      binary - a header (the 8 characters "CPUSIMRS", then version and number of columns as 32 bit ints) followed by
+ *               blocks of up to RESULTS_BLOCK_ROWS rows. Each block is the number of rows in it and then every column
+ *               in the order above, each as that many 64 bit ints, so a column can be read without reading the others
+ * Start is -1 for a job that never ran.
+ *
+ * Requires PCB.h, JobSource.h
+ */
+
+#ifndef RESULTSWRITER_H_INCLUDED
+#define RESULTSWRITER_H_INCLUDED
+
+#include "PCB.h"
+#include "JobSource.h"
+#include <fstream>
+#include <cstring>
+
+#define RESULTS_CSV 0
+#define RESULTS_BINARY 1
+#define RESULTS_MAGIC "CPUSIMRS"
+#define RESULTS_VERSION 1
+#define RESULTS_COLUMNS 8
+#define RESULTS_BLOCK_ROWS 65536
+
+using namespace std;
+
+class ResultsWriter{
+private:
+    ofstream out;
+    int format;
+    long rows;                              // Rows written so far
+    vector<char> text;                      // Rows not written yet (csv)
+    vector<long> columns[RESULTS_COLUMNS];  // Rows not written yet (binary)
+    void writeBlock();
+public:
+    ResultsWriter()             { format = RESULTS_CSV; rows = 0; }
+    ~ResultsWriter()            { close(); }
+    bool open(string filename, int fmt);
+    void record(PCB job)        { record(job.getResult()); }    // Record the row of a completed job (its end time must have been written)
+    void record(const jobResult &r);
+    bool close();
+    long getRows()              { return rows; }                // Read the number of rows recorded
+};
+
+/* Function to create the results file and write its header
+ * @param: fmt - RESULTS_CSV or RESULTS_BINARY
+ * Returns false if the file can't be created
+ */
+bool ResultsWriter::open(string filename, int fmt){
+    close();
+    format = fmt;
+    rows = 0;
+    out.clear();
+    out.open(filename.c_str(), ios::binary);
+    if(!out)
+        return false;
+
+    if(format == RESULTS_BINARY){
+        int header[4] = { 0, 0, RESULTS_VERSION, RESULTS_COLUMNS };
+        memcpy(header, RESULTS_MAGIC, 8);
+        out.write((const char *)header, sizeof(header));
+        for(int c=0; c<RESULTS_COLUMNS; c++)
+            columns[c].reserve(RESULTS_BLOCK_ROWS);
+    }
+    else{
+        static const char heading[] = "id,arrival,start,end,processing,wait,turnaround,shots\n";
+        out.write(heading, sizeof(heading) - 1);
+        text.reserve(1 << 20);
+    }
+    return (bool)out;
+}
+
+// Function to record the row of a completed job
+void ResultsWriter::record(const jobResult &r){
+    if(!out.is_open())
+        return;
+    long row[RESULTS_COLUMNS] = { r.id, r.arrival, r.start, r.end, r.processing, r.wait, r.turnaround, r.shots };
+    rows++;
+
+    if(format == RESULTS_BINARY){
+        for(int c=0; c<RESULTS_COLUMNS; c++)
+            columns[c].push_back(row[c]);
+        if(columns[0].size() == RESULTS_BLOCK_ROWS)
+            writeBlock();
+    }
+    else{
+        for(int c=0; c<RESULTS_COLUMNS; c++){
+            appendInt(text, row[c]);
+            text.push_back(c == RESULTS_COLUMNS - 1 ? '\n' : ',');
+        }
+        if(text.size() >= (1 << 20))
+            writeBlock();
+    }
+}
+
+// Function to write the rows collected so far to the file
+void ResultsWriter::writeBlock(){
+    if(format == RESULTS_BINARY){
+        long n = columns[0].size();
+        if(!n)
+            return;
+        out.write((const char *)&n, sizeof(n));
+        for(int c=0; c<RESULTS_COLUMNS; c++){
+            out.write((const char *)columns[c].data(), n*sizeof(long));
+            columns[c].clear();
+        }
+    }
+    else{
+        out.write(text.data(), text.size());
+        text.clear();
+    }
+}
+
+// Function to write the rows still in the buffer and close the file. Returns false if anything couldn't be written
+bool ResultsWriter::close(){
+    if(!out.is_open())
+        return true;
+    writeBlock();
+    bool ok = (bool)out;
+    out.close();
+    return ok && out;
+}
+
+#endif // RESULTSWRITER_H_INCLUDED
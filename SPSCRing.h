@@ -0,0 +1,111 @@
+/**
+ * This file contains the SPSCRing class, a lock-free ring buffer that passes items from one producer thread to one
+ * consumer thread (used by the pipeline, look at Pipeline.h).
+ *
+ * The producer only writes the tail and the consumer only writes the head, each with a single atomic store, so the two
+ * threads never wait on a lock. Items are pushed and popped in batches to keep the atomic operations rare, and head and
+ * tail are on separate cache lines so the threads don't slow each other down.
+ *
+ * The producer closes the ring once it has pushed its last item. The consumer cancels it if it stops reading early, so
+ * a producer blocked on a full ring gives up instead of waiting forever.
+ */
+
+#ifndef SPSCRING_H_INCLUDED
+#define SPSCRING_H_INCLUDED
+
+#include <atomic>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#define RING_CACHE_LINE 64
+
+using namespace std;
+
+template <class T>
+class SPSCRing{
+private:
+    vector<T> items;
+    size_t mask;                                            // Capacity - 1 (the capacity is a power of two)
+    alignas(RING_CACHE_LINE) atomic<size_t> head;           // Next item to pop (written by the consumer)
+    alignas(RING_CACHE_LINE) atomic<size_t> tail;           // Next free place (written by the producer)
+    alignas(RING_CACHE_LINE) atomic<bool> closed, cancelled;
+public:
+    SPSCRing(size_t capacity);
+    size_t push(const T *values, size_t n);
+    size_t pop(T *values, size_t n);
+    bool pushAll(const T *values, size_t n);
+    size_t popSome(T *values, size_t n);
+    void close()                { closed.store(true, memory_order_release); }       // No more items will be pushed (producer)
+    void cancel()               { cancelled.store(true, memory_order_release); }    // No more items will be popped (consumer)
+    bool isCancelled()          { return cancelled.load(memory_order_acquire); }    // Has the consumer stopped reading?
+};
+
+// Class constructor (the capacity is rounded up to a power of two)
+template <class T>
+SPSCRing<T>::SPSCRing(size_t capacity){
+    size_t size = 1;
+    while(size < capacity)
+        size *= 2;
+    items.resize(size);
+    mask = size - 1;
+    head.store(0);
+    tail.store(0);
+    closed.store(false);
+    cancelled.store(false);
+}
+
+// Function to push as many of n values as there is room for without waiting. Returns the number pushed (producer only)
+template <class T>
+size_t SPSCRing<T>::push(const T *values, size_t n){
+    size_t t = tail.load(memory_order_relaxed);
+    size_t room = items.size() - (t - head.load(memory_order_acquire));
+    n = min(n, room);
+    for(size_t i=0; i<n; i++)
+        items[(t + i) & mask] = values[i];
+    tail.store(t + n, memory_order_release);
+    return n;
+}
+
+// Function to pop up to n values without waiting. Returns the number popped (consumer only)
+template <class T>
+size_t SPSCRing<T>::pop(T *values, size_t n){
+    size_t h = head.load(memory_order_relaxed);
+    size_t available = tail.load(memory_order_acquire) - h;
+    n = min(n, available);
+    for(size_t i=0; i<n; i++)
+        values[i] = items[(h + i) & mask];
+    head.store(h + n, memory_order_release);
+    return n;
+}
+
+// Function to push n values, waiting for room as needed. Returns false if the consumer cancelled the ring first
+template <class T>
+bool SPSCRing<T>::pushAll(const T *values, size_t n){
+    while(n){
+        size_t pushed = push(values, n);
+        values += pushed;
+        n -= pushed;
+        if(n){
+            if(isCancelled())
+                return false;
+            this_thread::yield();
+        }
+    }
+    return true;
+}
+
+// Function to pop at least one and up to n values, waiting for them as needed. Returns 0 once the ring is closed and empty
+template <class T>
+size_t SPSCRing<T>::popSome(T *values, size_t n){
+    while(true){
+        size_t popped = pop(values, n);
+        if(popped)
+            return popped;
+        if(closed.load(memory_order_acquire))
+            return pop(values, n);      // Items pushed just before the ring was closed
+        this_thread::yield();
+    }
+}
+
+#endif // SPSCRING_H_INCLUDED
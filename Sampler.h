@@ -0,0 +1,128 @@
+/**
+ * This file contains the Sampler class. It records the state of the CPU at regular intervals of simulated time, so how
+ * the queues and the load change over a run can be looked at after it ends (look at CPU::setSampler()).
+ *
+ * Each sample holds the time it was taken at, the number of jobs in the ready queue, performing IO and in memory, and
+ * the running totals of the time the CPU was busy, context switches, preemptions, admissions and completed jobs up to
+ * that time (the idle time is the time minus the busy time). Samples are kept in a ring buffer allocated up front, so
+ * taking a sample never allocates memory. Once the buffer is full, each new sample replaces the oldest one.
+ *
+ * At the end of a run the samples are written to a file as a time series, oldest first, in one of two formats:
+ *      csv    - a header line followed by one line per sample
+ *      binary - a header (the 8 characters "CPUSIMTS", then version and number of columns as 32 bit ints), the number
+ *               of samples as a 64 bit int and then every column in the order of the csv header, each as that many
+ *               64 bit ints
+ *
+ * Requires JobSource.h, ResultsWriter.h
+ */
+
+#ifndef SAMPLER_H_INCLUDED
+#define SAMPLER_H_INCLUDED
+
+#include "JobSource.h"
+#include "ResultsWriter.h"
+#include <fstream>
+#include <cstring>
+
+#define SAMPLES_MAGIC "CPUSIMTS"
+#define SAMPLES_VERSION 1
+#define SAMPLES_COLUMNS 9
+#define SAMPLE_INTERVAL 200         // Default time between samples
+#define SAMPLE_CAPACITY 65536       // Default number of samples kept
+
+using namespace std;
+
+// State of the CPU at one time
+struct sample{
+    unsigned long time;
+    long ready, blocked, inMemory;
+    unsigned long busy, contextSwitches, preemptions, admissions, completed;
+};
+
+class Sampler{
+private:
+    vector<sample> ring;
+    size_t next;                // Where the next sample goes in the ring
+    unsigned long taken;        // Samples taken so far, including those replaced
+    unsigned long interval;
+    static void toRow(const sample &s, long row[SAMPLES_COLUMNS]);
+public:
+    Sampler(unsigned long i = SAMPLE_INTERVAL, size_t capacity = SAMPLE_CAPACITY);
+    unsigned long getInterval() { return interval; }                    // Read the time between samples
+    size_t size()               { return taken < ring.size() ? taken : ring.size(); }  // Read the number of samples kept
+    unsigned long dropped()     { return taken - size(); }              // Read the number of samples replaced by newer ones
+    void add(const sample &s);
+    const sample &get(size_t i);
+    bool write(string filename, int fmt);
+};
+
+// Class constructor (i is the time between samples, capacity the number of samples kept)
+Sampler::Sampler(unsigned long i, size_t capacity){
+    interval = max(i, 1UL);
+    ring.resize(max(capacity, (size_t)1));
+    next = 0;
+    taken = 0;
+}
+
+// Function to keep a sample, replacing the oldest one if the buffer is full
+inline void Sampler::add(const sample &s){
+    ring[next] = s;
+    if(++next == ring.size())
+        next = 0;
+    taken++;
+}
+
+// Function to read the i-th oldest sample kept
+const sample &Sampler::get(size_t i){
+    size_t first = taken < ring.size() ? 0 : next;
+    return ring[(first + i) % ring.size()];
+}
+
+// Function to put the values of a sample in the order of the columns of the file
+void Sampler::toRow(const sample &s, long row[SAMPLES_COLUMNS]){
+    long values[SAMPLES_COLUMNS] = { (long)s.time, s.ready, s.blocked, s.inMemory, (long)s.busy, (long)s.contextSwitches,
+                                     (long)s.preemptions, (long)s.admissions, (long)s.completed };
+    memcpy(row, values, sizeof(values));
+}
+
+/* Function to write the samples kept to a file, oldest first
+ * @param: fmt - RESULTS_CSV or RESULTS_BINARY
+ * Returns false if the file can't be written
+ */
+bool Sampler::write(string filename, int fmt){
+    ofstream out(filename.c_str(), ios::binary);
+    long n = size();
+
+    if(fmt == RESULTS_BINARY){
+        int header[4] = { 0, 0, SAMPLES_VERSION, SAMPLES_COLUMNS };
+        memcpy(header, SAMPLES_MAGIC, 8);
+        out.write((const char *)header, sizeof(header));
+        out.write((const char *)&n, sizeof(n));
+        vector<long> column(n);
+        for(int c=0; c<SAMPLES_COLUMNS; c++){
+            for(long i=0; i<n; i++){
+                long row[SAMPLES_COLUMNS];
+                toRow(get(i), row);
+                column[i] = row[c];
+            }
+            out.write((const char *)column.data(), n*sizeof(long));
+        }
+    }
+    else{
+        vector<char> text;
+        static const char heading[] = "time,ready,blocked,in_memory,busy,context_switches,preemptions,admissions,completed\n";
+        text.insert(text.end(), heading, heading + sizeof(heading) - 1);
+        for(long i=0; i<n; i++){
+            long row[SAMPLES_COLUMNS];
+            toRow(get(i), row);
+            for(int c=0; c<SAMPLES_COLUMNS; c++){
+                appendInt(text, row[c]);
+                text.push_back(c == SAMPLES_COLUMNS - 1 ? '\n' : ',');
+            }
+        }
+        out.write(text.data(), text.size());
+    }
+    return (bool)out;
+}
+
+#endif // SAMPLER_H_INCLUDED
@@ -0,0 +1,218 @@
+//***************************************************************************************
+// Simulator library
+// Implements the Simulator class (check Simulator.h). This is the only file of the library, so the simulator headers
+// (which define their functions) are compiled into it exactly once.
+// Required files: Simulator.h, CPU.h, stats.h, PCB.h, policy.h, scheduler.h, ReadyQueue.h, JobSource.h, Workload.h,
+//                 Histogram.h, ResultsWriter.h, IOSubsystem.h, Snapshot.h, Sampler.h, TraceWriter.h, Pipeline.h, SPSCRing.h,
+//                 Overhead.h
+//***************************************************************************************
+
+#include "Simulator.h"
+#include "CPU.h"
+#include "Workload.h"
+#include "policy.h"
+#include "scheduler.h"
+
+using namespace std;
+
+// Job source reading jobs given in memory
+class VectorJobSource : public JobSource{
+private:
+    const vector<simJob> &jobs;
+    size_t nextJob;
+public:
+    VectorJobSource(const vector<simJob> &j) : jobs(j)  { nextJob = 0; }
+    bool done()                 { return nextJob >= jobs.size(); }
+    bool next(jobRecord &job);
+};
+
+// Function to read the next job
+bool VectorJobSource::next(jobRecord &job){
+    if(done())
+        return false;
+    const simJob &j = jobs[nextJob++];
+    job.id = j.id;
+    job.arrivalTime = j.arrivalTime;
+    job.numBursts = j.bursts.size();
+    job.bursts = j.bursts.data();
+    return true;
+}
+
+/* Job source reading jobs from a function, which returns false once there are no more jobs
+ * One job is read ahead to know whether the source is done. The bursts of a job read stay valid until the next job is read
+ * A job without valid bursts ends the source
+ */
+class FunctionJobSource : public JobSource{
+private:
+    function<bool(simJob &)> nextJob;
+    simJob current, ahead;
+    bool fetched, hasAhead, invalid;
+public:
+    FunctionJobSource(function<bool(simJob &)> f)  { nextJob = f; fetched = hasAhead = invalid = false; }
+    bool done();
+    bool malformed()            { return invalid; }     // Did the function return a job without valid bursts?
+    bool next(jobRecord &job);
+};
+
+// Function to check if the function has no more jobs
+bool FunctionJobSource::done(){
+    if(!fetched){
+        hasAhead = nextJob(ahead);
+        if(hasAhead && !validBursts(ahead.bursts.data(), ahead.bursts.size())){
+            hasAhead = false;
+            invalid = true;
+        }
+        fetched = true;
+    }
+    return !hasAhead;
+}
+
+// Function to read the next job
+bool FunctionJobSource::next(jobRecord &job){
+    if(done())
+        return false;
+    swap(current, ahead);
+    fetched = false;
+    job.id = current.id;
+    job.arrivalTime = current.arrivalTime;
+    job.numBursts = current.bursts.size();
+    job.bursts = current.bursts.data();
+    return true;
+}
+
+// Default configuration: FCFS with the memory size and IO device of the original simulator
+simConfig::simConfig(){
+    policy = "FCFS";
+    quantum = 0;
+    priorities = PRIORITY_LEVELS;
+    levels = MLFQ_LEVELS;
+    maxJobs = MAX_JOBS;
+    ioTime = IO_TIME;
+    ioDevices = 1;
+    eventDriven = true;
+    admitOnArrival = false;
+    stopTime = ULONG_MAX;
+}
+
+// Function to read the percentiles of a histogram
+static simPercentiles readPercentiles(Histogram &h){
+    simPercentiles p = { h.percentile(50), h.percentile(90), h.percentile(99), h.percentile(99.9), h.getMax() };
+    return p;
+}
+
+// Function to run the configured policy over a job source and collect the results
+simResults Simulator::runSource(JobSource &jobs){
+    simResults r = simResults();
+    if(config.maxJobs <= 0 || config.ioTime <= 0 || config.ioDevices <= 0){
+        r.error = "Invalid memory size or IO devices";
+        return r;
+    }
+    if(jobs.endless() && config.stopTime == ULONG_MAX){
+        r.error = "A workload that never ends needs a stop time";
+        return r;
+    }
+
+    CPU myCPU(config.maxJobs, config.ioTime);
+    stats myStats;
+    myCPU.setVerbose(false);
+    myCPU.setAdmitOnArrival(config.admitOnArrival);
+    myCPU.setStopTime(config.stopTime);
+    myCPU.getIO().configure(vector<long>(config.ioDevices, config.ioTime));
+    if(!myCPU.getOverhead().setSpec(config.overhead)){
+        r.error = "Invalid overhead spec " + config.overhead;
+        return r;
+    }
+
+    bool known = true;
+    if(config.policy == "FCFS"){
+        FCFSPolicy policy;
+        r.valid = runSimulation(jobs, policy, myCPU, myStats, config.eventDriven);
+    }
+    else if(config.policy == "SJF"){
+        SJFPolicy policy;
+        r.valid = runSimulation(jobs, policy, myCPU, myStats, config.eventDriven);
+    }
+    else if(config.policy == "SRTF"){
+        SRTFPolicy policy;
+        r.valid = runSimulation(jobs, policy, myCPU, myStats, config.eventDriven);
+    }
+    else if(config.policy == "RR"){
+        RRPolicy policy(config.quantum);
+        r.valid = runSimulation(jobs, policy, myCPU, myStats, config.eventDriven);
+    }
+    else if(config.policy == "MLFQ"){
+        MLFQPolicy policy(config.levelQuanta.size() ? config.levelQuanta : levelQuanta(config.quantum, config.levels));
+        r.valid = runSimulation(jobs, policy, myCPU, myStats, config.eventDriven);
+    }
+    else if(config.policy == "PRIO"){
+        PriorityPolicy policy(config.quantum, config.priorities);
+        r.valid = runSimulation(jobs, policy, myCPU, myStats, config.eventDriven);
+    }
+    else
+        known = false;
+    if(!r.valid){
+        r.error = known ? "Invalid quantum or priorities for " + config.policy : "Unknown policy " + config.policy;
+        return r;
+    }
+    // Every job source stops at a malformed job, so the jobs after it were never simulated
+    if(jobs.malformed()){
+        r.valid = false;
+        r.error = "A job has no bursts, a burst shorter than 1 or is cut short";
+        return r;
+    }
+
+    long n = max(1L, myStats.getCount());
+    r.stopped = myCPU.stopped() && (myCPU.memoryUsed() || myCPU.pendingJob() || !jobs.done());
+    r.clock = myCPU.getCPUTime();
+    r.events = myCPU.getEvents();
+    r.busyTime = myCPU.getBusyTime();
+    r.contextSwitches = myCPU.getContextSwitches();
+    r.preemptions = myCPU.getPreemptions();
+    r.overheadTime = myCPU.getOverheadTime();
+    r.jobsCompleted = myStats.getCount();
+    r.avgPTime = (double)myStats.getPTime()/n;
+    r.avgWTime = (double)myStats.getwTime()/n;
+    r.avgTaTime = (double)myStats.gettaTime()/n;
+    r.avgShots = (double)myStats.getShots()/n;
+    r.wTime = readPercentiles(myStats.getwTimeHist());
+    r.taTime = readPercentiles(myStats.gettaTimeHist());
+    r.shots = readPercentiles(myStats.getShotsHist());
+    return r;
+}
+
+// Function to simulate the jobs of a job file (text or binary) or a workload spec (gen:...) (every job needs at least one burst, each at least 1 unit of time long)
+simResults Simulator::run(const string &jobs){
+    JobSource *source = openJobs(jobs);
+    if(!source){
+        simResults r = simResults();
+        r.error = "Could not open " + jobs;
+        return r;
+    }
+    simResults r = runSource(*source);
+    delete source;
+    return r;
+}
+
+// Function to simulate jobs given in memory (every job needs at least one burst, each at least 1 unit of time long)
+simResults Simulator::run(const vector<simJob> &jobs){
+    for(size_t i=0; i<jobs.size(); i++)
+        if(!validBursts(jobs[i].bursts.data(), jobs[i].bursts.size())){
+            simResults r = simResults();
+            r.error = "A job has no bursts or a burst shorter than 1";
+            return r;
+        }
+    VectorJobSource source(jobs);
+    return runSource(source);
+}
+
+// Function to simulate a trace in the binary trace format, without its header (check JobSource.h and readTrace())
+simResults Simulator::runTrace(const vector<int> &trace){
+    BinaryJobSource source(trace.data(), trace.data() + trace.size());
+    return runSource(source);
+}
+
+// Function to simulate the jobs returned by a function, read as they are loaded into memory (every job needs at least one burst, each at least 1 unit of time long)
+simResults Simulator::runFrom(function<bool(simJob &)> nextJob){
+    FunctionJobSource source(nextJob);
+    return runSource(source);
+}
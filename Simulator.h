@@ -0,0 +1,79 @@
+/**
+ * This file contains the Simulator class, the interface of the simulator library (libcpusimlib). It lets a program run
+ * simulations in process and get their results back as numbers, without anything being printed.
+ *
+ * A Simulator holds a configuration (policy, quantum, memory size, IO devices, ...) and runs it over the jobs it is
+ * given, which can be a job file or workload spec, jobs in memory, a trace in the binary trace format or a function
+ * producing one job at a time. Every run builds its own CPU, queues and statistics, and the library has no global
+ * state, so any number of simulators (or runs of one simulator) can run concurrently on different threads.
+ *
+ * This is the only header a program using the library includes. The simulator itself is in the other headers, which
+ * are compiled into the library (Simulator.cpp).
+ */
+
+#ifndef SIMULATOR_H_INCLUDED
+#define SIMULATOR_H_INCLUDED
+
+#include <string>
+#include <vector>
+#include <functional>
+
+using namespace std;
+
+class JobSource;
+
+// Configuration of a simulation
+struct simConfig{
+    string policy;              // FCFS, SJF, SRTF, RR, MLFQ or PRIO
+    int quantum;                // Time quantum of RR, quantum of the top level of MLFQ, aging interval of PRIO
+    vector<int> levelQuanta;    // Quantum of every level of MLFQ, highest first (if empty: levels levels starting with quantum)
+    int levels;                 // Number of levels of MLFQ built from quantum, each with twice the quantum of the level above
+    int priorities;             // Number of priorities of PRIO
+    int maxJobs;                // Number of jobs that fit in memory at a time
+    long ioTime;                // Time an IO operation takes
+    int ioDevices;              // Number of IO devices
+    bool eventDriven;           // Use the event driven engine (same results as the tick engine, faster)
+    bool admitOnArrival;        // Only admit jobs once the clock reaches their arrival time
+    unsigned long stopTime;     // Stop the simulation when the clock reaches this time
+    string overhead;            // Cost of context switches, dispatches, admissions and IO system calls, as an overhead spec (none if empty)
+    simConfig();
+};
+
+// Job given to the simulator
+struct simJob{
+    int id;
+    long arrivalTime;
+    vector<int> bursts;         // Length of every CPU burst
+};
+
+// Percentiles of one metric over the jobs completed
+struct simPercentiles{
+    long p50, p90, p99, p999, max;
+};
+
+// Results of a simulation
+struct simResults{
+    bool valid;                 // Did the simulation run? If not, error says why
+    string error;
+    bool stopped;               // Was the simulation stopped at the stop time before every job completed?
+    unsigned long clock, events, busyTime, contextSwitches, preemptions;
+    unsigned long overheadTime; // Time charged for overhead (check Overhead.h)
+    long jobsCompleted;
+    double avgPTime, avgWTime, avgTaTime, avgShots;
+    simPercentiles wTime, taTime, shots;
+};
+
+class Simulator{
+private:
+    simConfig config;
+    simResults runSource(JobSource &jobs);
+public:
+    Simulator(const simConfig &c = simConfig())    { config = c; }
+    simConfig &getConfig()      { return config; }      // Read or change the configuration used by the next runs
+    simResults run(const string &jobs);
+    simResults run(const vector<simJob> &jobs);
+    simResults runTrace(const vector<int> &trace);
+    simResults runFrom(function<bool(simJob &)> nextJob);
+};
+
+#endif // SIMULATOR_H_INCLUDED
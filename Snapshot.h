@@ -0,0 +1,112 @@
+/**
+ * This file contains the SnapshotWriter and SnapshotReader classes, used to save the state of a simulation to a
+ * binary snapshot file and read it back (look at CPU::saveSnapshot()).
+ *
+ * A snapshot is the 8 characters "CPUSIMCK" and a 32 bit version, followed by the state of every part of the
+ * simulation, each written by the part itself as raw values and arrays (an array is its length followed by its
+ * elements). Snapshots are only meant to be read back by the same build of the simulator on the same machine.
+ */
+
+#ifndef SNAPSHOT_H_INCLUDED
+#define SNAPSHOT_H_INCLUDED
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstring>
+#include <iterator>
+
+#define SNAPSHOT_MAGIC "CPUSIMCK"
+#define SNAPSHOT_VERSION 3
+
+using namespace std;
+
+// Collects the state of a simulation in memory, to be written to a file at once
+class SnapshotWriter{
+private:
+    vector<char> data;
+public:
+    SnapshotWriter();
+    template <class T> void put(const T &value);
+    template <class T> void putVector(const vector<T> &values);
+    bool save(string filename);
+};
+
+// Reads back the state collected by a SnapshotWriter. Reading past the end fails the reader instead of reading garbage
+class SnapshotReader{
+private:
+    vector<char> data;
+    size_t pos;
+    bool ok;
+public:
+    SnapshotReader()            { pos = 0; ok = false; }
+    bool open(string filename);
+    bool good()                 { return ok; }              // Has everything read so far been in the snapshot?
+    template <class T> bool get(T &value);
+    template <class T> bool getVector(vector<T> &values);
+};
+
+// Default class constructor (starts the snapshot with its header)
+SnapshotWriter::SnapshotWriter(){
+    data.insert(data.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + 8);
+    put((int)SNAPSHOT_VERSION);
+}
+
+// Function to add a value to the snapshot
+template <class T>
+void SnapshotWriter::put(const T &value){
+    const char *bytes = (const char *)&value;
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+// Function to add an array of values to the snapshot
+template <class T>
+void SnapshotWriter::putVector(const vector<T> &values){
+    put((unsigned long)values.size());
+    if(values.size()){          // An empty vector may not have any storage to copy from
+        const char *bytes = (const char *)values.data();
+        data.insert(data.end(), bytes, bytes + values.size()*sizeof(T));
+    }
+}
+
+// Function to write the snapshot to a file. Returns false if it can't be written
+bool SnapshotWriter::save(string filename){
+    ofstream out(filename.c_str(), ios::binary);
+    out.write(data.data(), data.size());
+    return (bool)out;
+}
+
+// Function to read a snapshot file. Returns false if it can't be read or is not a snapshot of this version
+bool SnapshotReader::open(string filename){
+    ifstream in(filename.c_str(), ios::binary);
+    data.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    pos = 8;
+    ok = data.size() >= 8 && !memcmp(data.data(), SNAPSHOT_MAGIC, 8);
+    int version;
+    return get(version) && version == SNAPSHOT_VERSION;
+}
+
+// Function to read the next value of the snapshot. Returns false if the snapshot ended
+template <class T>
+bool SnapshotReader::get(T &value){
+    if(!ok || data.size() - pos < sizeof(T))
+        return ok = false;
+    memcpy(&value, data.data() + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+
+// Function to read the next array of the snapshot. Returns false if the snapshot ended
+template <class T>
+bool SnapshotReader::getVector(vector<T> &values){
+    unsigned long n;
+    if(!get(n) || (data.size() - pos)/sizeof(T) < n)
+        return ok = false;
+    values.resize(n);
+    if(n)                       // An empty vector may not have any storage to copy into
+        memcpy((char *)values.data(), data.data() + pos, n*sizeof(T));
+    pos += n*sizeof(T);
+    return true;
+}
+
+#endif // SNAPSHOT_H_INCLUDED
@@ -0,0 +1,140 @@
+/**
+ * This file contains the parameter sweep. It runs a grid of scheduler configurations over one trace, concurrently on
+ * a pool of threads, and prints the results as one comparison table.
+ *
+ * The trace is read into memory once, in the binary trace format, and every run reads it through its own
+ * BinaryJobSource. Each run has its own CPU, PCBs and stats, so the runs share nothing but the read only trace.
+ *
+ * Requires CPU.h, stats.h, scheduler.h, JobSource.h, Overhead.h
+ */
+
+#ifndef SWEEP_H_INCLUDED
+#define SWEEP_H_INCLUDED
+
+#include "scheduler.h"
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+using namespace std;
+
+// One configuration of the scheduler
+struct sweepConfig{
+    string policy;
+    int quantum, maxJobs, ioTime;
+    int levels;                 // Levels of MLFQ, the top one with the quantum (check levelQuanta())
+};
+
+// Summary of one run of the sweep
+struct sweepResult{
+    bool valid;
+    unsigned long clock, events;
+    double avgPTime, avgWTime, avgTaTime, avgShots, seconds;
+    long p99WTime, p99TaTime;
+};
+
+// Function to parse a comma separated list of numbers
+vector<long> parseList(string text){
+    vector<long> values;
+    istringstream items(text);
+    string item;
+    while(getline(items, item, ','))
+        values.push_back(atol(item.c_str()));
+    return values;
+}
+
+// Function to build the grid of configurations: FCFS, SJF, SRTF, and RR and MLFQ with every quantum, for every memory size and IO time
+vector<sweepConfig> sweepGrid(vector<long> quanta, vector<long> memorySizes, vector<long> ioTimes, int levels = MLFQ_LEVELS){
+    vector<sweepConfig> grid;
+    for(size_t m=0; m<memorySizes.size(); m++)
+        for(size_t io=0; io<ioTimes.size(); io++){
+            sweepConfig c = { "FCFS", 0, (int)memorySizes[m], (int)ioTimes[io], levels };
+            grid.push_back(c);
+            c.policy = "SJF";
+            grid.push_back(c);
+            c.policy = "SRTF";
+            grid.push_back(c);
+            c.policy = "RR";
+            for(size_t q=0; q<quanta.size(); q++){
+                c.quantum = quanta[q];
+                grid.push_back(c);
+            }
+            c.policy = "MLFQ";
+            for(size_t q=0; q<quanta.size(); q++){
+                c.quantum = quanta[q];
+                grid.push_back(c);
+            }
+        }
+    return grid;
+}
+
+// Function to run one configuration over the trace
+sweepResult runConfig(const vector<int> &trace, sweepConfig &config, bool eventDriven, const Overhead &overhead){
+    sweepResult r;
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    CPU myCPU(config.maxJobs, config.ioTime);
+    stats myStats;
+    myCPU.setVerbose(false);
+    myCPU.getOverhead() = overhead;     // Every run draws the same costs from its own copy
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    r.valid = config.maxJobs > 0 && config.ioTime > 0
+              && runPolicy(config.policy, config.quantum, JobQ, myCPU, myStats, eventDriven, config.levels);
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    long n = max(1L, myStats.getCount());
+    r.clock = myCPU.getCPUTime();
+    r.events = myCPU.getEvents();
+    r.avgPTime = (double)myStats.getPTime()/n;
+    r.avgWTime = (double)myStats.getwTime()/n;
+    r.avgTaTime = (double)myStats.gettaTime()/n;
+    r.avgShots = (double)myStats.getShots()/n;
+    r.p99WTime = myStats.getwTimeHist().percentile(99);
+    r.p99TaTime = myStats.gettaTimeHist().percentile(99);
+    return r;
+}
+
+/* Function to run every configuration of the grid over the trace
+ * The runs are handed out to the threads one at a time, so a slow run doesn't hold up the others
+ * @param: threads - number of threads to use (0 means one per hardware thread)
+ *         overhead - costs of context switches, dispatches, admissions and IO system calls in every run (check Overhead.h)
+ */
+vector<sweepResult> runSweep(const vector<int> &trace, vector<sweepConfig> &grid, int threads, bool eventDriven,
+                             const Overhead &overhead = Overhead()){
+    vector<sweepResult> results(grid.size());
+    atomic<size_t> nextConfig(0);
+
+    if(threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+    threads = min((size_t)threads, grid.size());
+
+    vector<thread> pool;
+    for(int t=0; t<threads; t++)
+        pool.push_back(thread([&](){
+            for(size_t i = nextConfig++; i < grid.size(); i = nextConfig++)
+                results[i] = runConfig(trace, grid[i], eventDriven, overhead);
+        }));
+    for(size_t t=0; t<pool.size(); t++)
+        pool[t].join();
+    return results;
+}
+
+// Function to print the results of the sweep as a table, one row per configuration
+void printSweepTable(vector<sweepConfig> &grid, vector<sweepResult> &results){
+    printf("%-6s %7s %8s %7s %12s %12s %12s %12s %12s %12s %10s %9s\n", "policy", "quantum", "max_jobs", "io_time",
+           "clock", "avg_process", "avg_wait", "p99_wait", "avg_turn", "p99_turn", "avg_shots", "seconds");
+    for(size_t i=0; i<grid.size(); i++){
+        sweepResult &r = results[i];
+        if(!r.valid){
+            printf("%-6s %7d %8d %7d  invalid configuration\n", grid[i].policy.c_str(), grid[i].quantum,
+                   grid[i].maxJobs, grid[i].ioTime);
+            continue;
+        }
+        printf("%-6s %7d %8d %7d %12lu %12.2f %12.2f %12ld %12.2f %12ld %10.2f %9.3f\n", grid[i].policy.c_str(),
+               grid[i].quantum, grid[i].maxJobs, grid[i].ioTime, r.clock, r.avgPTime, r.avgWTime, r.p99WTime, r.avgTaTime,
+               r.p99TaTime, r.avgShots, r.seconds);
+    }
+}
+
+#endif // SWEEP_H_INCLUDED
@@ -0,0 +1,171 @@
+/**
+ * This file contains the TraceWriter class. It writes the schedule of a simulation as a Chrome trace-event JSON file,
+ * which can be opened in chrome://tracing or Perfetto (ui.perfetto.dev) to see which job held the CPU and when.
+ *
+ * The trace has one track for the CPU and one for every IO device. Every CPU shot (a job running without interruption)
+ * and every IO operation is a slice on its track, named after the job, and every preemption is an instant event on the
+ * CPU track. One unit of simulated time is shown as one microsecond.
+ *
+ * Events are formatted into a large buffer and written to the file in big blocks as the simulation runs, so a trace of
+ * any length is written without holding its events in memory.
+ *
+ * Requires JobSource.h
+ */
+
+#ifndef TRACEWRITER_H_INCLUDED
+#define TRACEWRITER_H_INCLUDED
+
+#include "JobSource.h"
+#include <fstream>
+#include <cstring>
+
+#define TRACE_BUFFER_SIZE (1 << 20)
+#define TRACE_CPU_TRACK 0       // Track of the CPU. IO device d is track TRACE_CPU_TRACK + 1 + d
+
+using namespace std;
+
+class TraceWriter{
+private:
+    ofstream out;
+    vector<char> text;          // Events not written yet
+    vector<char> named;         // Has the name of each IO device track been written?
+    unsigned long events;
+    void append(const char *s)  { text.insert(text.end(), s, s + strlen(s)); }
+    void beginEvent(const char *name, int id, const char *cat, const char *ph, int track, unsigned long ts);
+    void endEvent(int id);
+    void nameTrack(int track, const char *name, int number);
+public:
+    TraceWriter()               { events = 0; }
+    ~TraceWriter()              { close(); }
+    bool open(string filename);
+    void shot(int id, unsigned long start, unsigned long end);
+    void io(int id, int device, unsigned long start, unsigned long end);
+    void preemption(int id, unsigned long t);
+    void overhead(unsigned long start, unsigned long end);
+    unsigned long getEvents()   { return events; }      // Read the number of events written
+    bool close();
+};
+
+// Function to create the trace file and start the list of events
+bool TraceWriter::open(string filename){
+    close();
+    events = 0;
+    named.clear();
+    out.clear();
+    out.open(filename.c_str(), ios::binary);
+    if(!out)
+        return false;
+    text.reserve(TRACE_BUFFER_SIZE + 4096);
+    append("{\"traceEvents\":[\n");
+    nameTrack(TRACE_CPU_TRACK, "CPU", -1);
+    return (bool)out;
+}
+
+// Function to start an event of a job: its name, category, phase, track and time (the caller adds the rest and ends it)
+void TraceWriter::beginEvent(const char *name, int id, const char *cat, const char *ph, int track, unsigned long ts){
+    if(events++)
+        append(",\n");
+    append("{\"name\":\"");
+    append(name);
+    if(id >= 0){
+        text.push_back(' ');
+        appendInt(text, id);
+    }
+    append("\",\"cat\":\"");
+    append(cat);
+    append("\",\"ph\":\"");
+    append(ph);
+    append("\",\"pid\":0,\"tid\":");
+    appendInt(text, track);
+    append(",\"ts\":");
+    appendInt(text, ts);
+}
+
+// Function to end an event, with the ID of its job as its argument, and write the buffer out once it is full
+void TraceWriter::endEvent(int id){
+    append(",\"args\":{\"job\":");
+    appendInt(text, id);
+    append("}}");
+    if(text.size() >= TRACE_BUFFER_SIZE){
+        out.write(text.data(), text.size());
+        text.clear();
+    }
+}
+
+// Function to name a track (number is appended to the name unless it is negative)
+void TraceWriter::nameTrack(int track, const char *name, int number){
+    if(events++)
+        append(",\n");
+    append("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":");
+    appendInt(text, track);
+    append(",\"args\":{\"name\":\"");
+    append(name);
+    if(number >= 0){
+        text.push_back(' ');
+        appendInt(text, number);
+    }
+    append("\"}}");
+}
+
+// Function to add a CPU shot: the job ran from start until end
+void TraceWriter::shot(int id, unsigned long start, unsigned long end){
+    if(!out.is_open())
+        return;
+    beginEvent("job", id, "cpu", "X", TRACE_CPU_TRACK, start);
+    append(",\"dur\":");
+    appendInt(text, end - start);
+    endEvent(id);
+}
+
+// Function to add an IO operation of a job on a device, performed from start until end
+void TraceWriter::io(int id, int device, unsigned long start, unsigned long end){
+    if(!out.is_open())
+        return;
+    if(device >= (int)named.size())
+        named.resize(device + 1, 0);
+    if(!named[device]){
+        nameTrack(TRACE_CPU_TRACK + 1 + device, "IO device", device);
+        named[device] = 1;
+    }
+    beginEvent("job", id, "io", "X", TRACE_CPU_TRACK + 1 + device, start);
+    append(",\"dur\":");
+    appendInt(text, end - start);
+    endEvent(id);
+}
+
+// Function to add the preemption of a job at time t
+void TraceWriter::preemption(int id, unsigned long t){
+    if(!out.is_open())
+        return;
+    beginEvent("preempt", id, "cpu", "i", TRACE_CPU_TRACK, t);
+    append(",\"s\":\"t\"");
+    endEvent(id);
+}
+
+// Function to add a stretch of overhead (look at Overhead.h) on the CPU track, paid from start until end
+void TraceWriter::overhead(unsigned long start, unsigned long end){
+    if(!out.is_open())
+        return;
+    beginEvent("overhead", -1, "cpu", "X", TRACE_CPU_TRACK, start);
+    append(",\"dur\":");
+    appendInt(text, end - start);
+    append("}");
+    if(text.size() >= TRACE_BUFFER_SIZE){
+        out.write(text.data(), text.size());
+        text.clear();
+    }
+}
+
+// Function to end the list of events, write what is still in the buffer and close the file. Returns false if anything couldn't be written
+bool TraceWriter::close(){
+    if(!out.is_open())
+        return true;
+    append("\n]}\n");
+    out.write(text.data(), text.size());
+    text.clear();
+    bool ok = (bool)out;
+    out.close();
+    return ok && out;
+}
+
+#endif // TRACEWRITER_H_INCLUDED
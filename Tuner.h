@@ -0,0 +1,322 @@
+/**
+ * This file contains the QuantumTuner class. It searches for the time quantum that makes RR best at one objective over
+ * a trace, running the candidate quanta concurrently on a pool of threads.
+ *
+ * Objectives (the best quantum is the one with the smallest value, or the largest for throughput):
+ *      wait            - average waiting time
+ *      p99-wait        - 99th percentile of the waiting time
+ *      turnaround      - average turn around time
+ *      p99-turnaround  - 99th percentile of the turn around time
+ *      throughput      - jobs completed per 1000 units of time
+ *
+ * The search starts with a coarse grid of quanta spread evenly on a log scale over the range, then repeatedly tries
+ * quanta between the best one and its nearest neighbours tried so far, until they are next to each other. This finds
+ * the best quantum of a curve with one minimum, and a good one otherwise, with a few dozen runs.
+ *
+ * Every run is simulated in steps (stopping and continuing at a stop time gives the same result as one run). After each
+ * step, a lower bound of the final value is worked out from what is known so far: the jobs completed, the jobs not yet
+ * read (which have already waited since they arrived) and the CPU work still to do. Once the bound shows the run can't
+ * beat the best run completed so far, it is abandoned. The bounds of the waiting and turn around times assume no job
+ * waits less than 0, which only holds if jobs are admitted on arrival, so otherwise only throughput runs are abandoned.
+ * A tie goes to the smaller quantum, so the best quantum found does not depend on the order the runs complete in (though
+ * which runs are abandoned does).
+ *
+ * Requires CPU.h, stats.h, scheduler.h, JobSource.h, Histogram.h, Overhead.h
+ */
+
+#ifndef TUNER_H_INCLUDED
+#define TUNER_H_INCLUDED
+
+#include "scheduler.h"
+#include <thread>
+#include <mutex>
+#include <map>
+#include <cmath>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+#define TUNE_WAIT 0
+#define TUNE_P99_WAIT 1
+#define TUNE_TURNAROUND 2
+#define TUNE_P99_TURNAROUND 3
+#define TUNE_THROUGHPUT 4
+
+#define TUNE_GRID 16            // Quanta in the first, coarse grid
+#define TUNE_POINTS 8           // Quanta tried between the best quantum and each of its neighbours in every later round
+#define TUNE_STEPS 64           // Steps a run is split into (roughly), to check whether it can still beat the best
+
+using namespace std;
+
+// One quantum tried by the tuner
+struct tuneCandidate{
+    int quantum;
+    bool abandoned;             // Was the run stopped once it couldn't beat the best run?
+    long long value;            // Objective of the run (sum of the metric for averages, clock for throughput), or its lower bound if abandoned
+    unsigned long clock;        // Clock at the end of the run (or when it was abandoned)
+    double seconds;
+};
+
+class QuantumTuner{
+private:
+    const vector<int> &trace;
+    int objective, maxJobs, ioTime;
+    Overhead overhead;
+    bool eventDriven;
+    bool admitOnArrival;        // Are jobs only admitted once the clock reaches their arrival time?
+    long jobs;                  // Number of jobs in the trace
+    long long work;             // CPU time all the jobs need
+    vector<long> arrivals;      // Arrival time of every job, in trace order
+    vector<long long> arrivalSums;  // arrivalSums[i] is the sum of the first i arrival times
+    bool sortedArrivals;        // Do jobs appear in order of arrival? (needed to bound what jobs not yet read will wait)
+    mutex bestLock;
+    long long bestValue;
+    int bestQuantum;            // 0 until a run completes
+    map<int, tuneCandidate> tried;
+    bool better(long long value, int quantum, long long than, int thanQuantum);
+    long long finalValue(CPU &cpu, stats &s);
+    long long lowerBound(CPU &cpu, stats &s);
+    void evaluate(tuneCandidate &c);
+    void runRound(vector<int> quanta, int threads);
+public:
+    QuantumTuner(const vector<int> &t, int obj, int memory, int io, const Overhead &o, bool e);
+    void setAdmitOnArrival(bool a)  { admitOnArrival = a; }     // Choose whether jobs are only admitted once they have arrived
+    int tune(int low, int high, int threads);
+    int tune(const vector<int> &quanta, int threads);
+    double valueOf(const tuneCandidate &c);
+    void printCurve();
+};
+
+// Function to parse the name of an objective. Returns -1 if it is not an objective
+int parseObjective(string name){
+    const char *names[] = { "wait", "p99-wait", "turnaround", "p99-turnaround", "throughput" };
+    for(int i=0; i<5; i++)
+        if(name == names[i])
+            return i;
+    return -1;
+}
+
+// Class constructor (reads the arrival times and the work of the jobs of the trace, in the binary trace format)
+QuantumTuner::QuantumTuner(const vector<int> &t, int obj, int memory, int io, const Overhead &o, bool e) : trace(t){
+    objective = obj;
+    maxJobs = memory;
+    ioTime = io;
+    overhead = o;
+    eventDriven = e;
+    admitOnArrival = false;
+    bestValue = 0;
+    bestQuantum = 0;
+
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    jobRecord job;
+    work = 0;
+    sortedArrivals = true;
+    arrivalSums.push_back(0);
+    while(JobQ.next(job)){
+        if(arrivals.size() && job.arrivalTime < arrivals.back())
+            sortedArrivals = false;
+        arrivals.push_back(max(0L, job.arrivalTime));
+        arrivalSums.push_back(arrivalSums.back() + arrivals.back());
+        for(int i=0; i<job.numBursts; i++)
+            work += job.bursts[i];
+    }
+    jobs = arrivals.size();
+}
+
+// Function to compare two runs: a smaller value is better, and a tie goes to the smaller quantum
+bool QuantumTuner::better(long long value, int quantum, long long than, int thanQuantum){
+    return value < than || (value == than && quantum < thanQuantum);
+}
+
+// Function to read the objective of a run that completed every job
+long long QuantumTuner::finalValue(CPU &cpu, stats &s){
+    switch(objective){
+    case TUNE_WAIT:
+        return s.getwTime();
+    case TUNE_P99_WAIT:
+        return s.getwTimeHist().percentile(99);
+    case TUNE_TURNAROUND:
+        return s.gettaTime();
+    case TUNE_P99_TURNAROUND:
+        return s.gettaTimeHist().percentile(99);
+    }
+    return cpu.getCPUTime();
+}
+
+/* Function to work out a value the objective of a run stopped part way can't end up below
+ * Jobs still to complete are taken to wait at least 0, so the waiting and turn around times are only bounded if jobs are
+ * admitted on arrival (a job loaded before it arrives ends up with a negative waiting time). A job not read yet that arrived at a before now waits (and turns around in) at least now - a, since it hasn't run at all.
+ * A percentile is at least the value of the same rank among the values of the jobs completed and these bounds. The clock
+ * can't end before the CPU has done the work that is left
+ */
+long long QuantumTuner::lowerBound(CPU &cpu, stats &s){
+    long long now = cpu.getCPUTime();
+    long read = cpu.jobsCompleted() + cpu.memoryUsed() + (cpu.pendingJob() ? 1 : 0);
+    // Jobs not read yet that have arrived are arrivals[read..arrived)
+    long arrived = read;
+    if(sortedArrivals)
+        arrived = upper_bound(arrivals.begin() + read, arrivals.end(), now) - arrivals.begin();
+
+    if(objective == TUNE_WAIT || objective == TUNE_TURNAROUND){
+        long long total = objective == TUNE_WAIT ? s.getwTime() : s.gettaTime();
+        return total + (arrived - read)*now - (arrivalSums[arrived] - arrivalSums[read]);
+    }
+    if(objective == TUNE_P99_WAIT || objective == TUNE_P99_TURNAROUND){
+        // The percentile is the m-th largest value (ranked as in Histogram::percentile())
+        unsigned long rank = max(1UL, min((unsigned long)(0.99*jobs + 0.5), (unsigned long)jobs));
+        unsigned long m = jobs - rank + 1;
+        vector<long> values;
+        (objective == TUNE_P99_WAIT ? s.getwTimeHist() : s.gettaTimeHist()).largest(m, values);
+        for(long i=read; i<arrived && i-read < (long)m; i++)
+            values.push_back(now - arrivals[i]);
+        if(values.size() < m)
+            return 0;
+        nth_element(values.begin(), values.begin() + (m - 1), values.end(), greater<long>());
+        return values[m - 1];
+    }
+    return now + max(0LL, work - (long long)cpu.getBusyTime());
+}
+
+// Function to run one quantum, in steps, until every job completes or it can't beat the best run any more
+void QuantumTuner::evaluate(tuneCandidate &c){
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    CPU myCPU(maxJobs, ioTime);
+    stats myStats;
+    RRPolicy policy(c.quantum);
+    myCPU.setVerbose(false);
+    myCPU.setAdmitOnArrival(admitOnArrival);
+    myCPU.getOverhead() = overhead;
+    unsigned long step = max(1000LL, work/TUNE_STEPS);
+    bool bounded = admitOnArrival || objective == TUNE_THROUGHPUT;     // Can the run be abandoned? (check lowerBound())
+    c.abandoned = false;
+
+    for(unsigned long stop = step; ; stop += step){
+        myCPU.setStopTime(stop);
+        runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+        if(!myCPU.memoryUsed() && !myCPU.pendingJob() && JobQ.done())
+            break;
+        if(!bounded)
+            continue;
+
+        long long bound = lowerBound(myCPU, myStats);
+        lock_guard<mutex> lock(bestLock);
+        if(bestQuantum && !better(bound, c.quantum, bestValue, bestQuantum)){
+            c.abandoned = true;
+            c.value = bound;
+            break;
+        }
+    }
+    if(!c.abandoned){
+        c.value = finalValue(myCPU, myStats);
+        lock_guard<mutex> lock(bestLock);
+        if(!bestQuantum || better(c.value, c.quantum, bestValue, bestQuantum)){
+            bestValue = c.value;
+            bestQuantum = c.quantum;
+        }
+    }
+    c.clock = myCPU.getCPUTime();
+    c.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/* Function to run a round of quanta concurrently (0 threads means one per hardware thread)
+ * The largest quanta are started first: they have the fewest preemptions to simulate, so a best run is known early
+ */
+void QuantumTuner::runRound(vector<int> quanta, int threads){
+    vector<tuneCandidate> round(quanta.size());
+    sort(quanta.rbegin(), quanta.rend());
+    for(size_t i=0; i<quanta.size(); i++)
+        round[i].quantum = quanta[i];
+    atomic<size_t> nextCandidate(0);
+
+    if(threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+    threads = min((size_t)threads, round.size());
+
+    vector<thread> pool;
+    for(int t=0; t<threads; t++)
+        pool.push_back(thread([&](){
+            for(size_t i = nextCandidate++; i < round.size(); i = nextCandidate++)
+                evaluate(round[i]);
+        }));
+    for(size_t t=0; t<pool.size(); t++)
+        pool[t].join();
+    for(size_t i=0; i<round.size(); i++)
+        tried[round[i].quantum] = round[i];
+}
+
+/* Function to search for the best quantum from low to high (both at least 1)
+ * Returns the best quantum (0 if the range is invalid or the trace has no jobs)
+ */
+int QuantumTuner::tune(int low, int high, int threads){
+    if(low <= 0 || high < low || !jobs)
+        return 0;
+
+    // Coarse grid, evenly spread on a log scale
+    vector<int> quanta;
+    for(int i=0; i<TUNE_GRID; i++){
+        int q = (int)(low*pow((double)high/low, (double)i/(TUNE_GRID - 1)) + 0.5);
+        q = max(low, min(q, high));
+        if(quanta.empty() || q > quanta.back())
+            quanta.push_back(q);
+    }
+
+    // Narrow down around the best quantum until its neighbours are next to it
+    while(quanta.size()){
+        runRound(quanta, threads);
+        quanta.clear();
+        map<int, tuneCandidate>::iterator best = tried.find(bestQuantum);
+        int below = best == tried.begin() ? low - 1 : prev(best)->first;
+        int above = next(best) == tried.end() ? high + 1 : next(best)->first;
+        for(int side=0; side<2; side++){
+            int from = side ? bestQuantum : below, to = side ? above : bestQuantum;
+            for(int i=1; i<=TUNE_POINTS; i++){
+                int q = from + (int)((long)(to - from)*i/(TUNE_POINTS + 1));
+                if(q > from && q < to && !tried.count(q) && (quanta.empty() || q > quanta.back()))
+                    quanta.push_back(q);
+            }
+        }
+    }
+    return bestQuantum;
+}
+
+// Function to find the best of a list of quanta (all at least 1). Returns the best quantum (0 if none is valid)
+int QuantumTuner::tune(const vector<int> &quanta, int threads){
+    vector<int> sorted(quanta);
+    sort(sorted.begin(), sorted.end());
+    sorted.erase(unique(sorted.begin(), sorted.end()), sorted.end());
+    if(sorted.empty() || sorted[0] <= 0 || !jobs)
+        return 0;
+    runRound(sorted, threads);
+    return bestQuantum;
+}
+
+// Function to convert the value of a run to the objective as printed (an average, a percentile, or jobs per 1000 units of time)
+double QuantumTuner::valueOf(const tuneCandidate &c){
+    if(objective == TUNE_WAIT || objective == TUNE_TURNAROUND)
+        return (double)c.value/jobs;
+    if(objective == TUNE_THROUGHPUT)
+        return c.value ? 1000.0*jobs/c.value : 0;
+    return c.value;
+}
+
+// Function to print every quantum tried in order, as the curve of the objective, and the best quantum
+void QuantumTuner::printCurve(){
+    const char *names[] = { "avg_wait", "p99_wait", "avg_turn", "p99_turn", "throughput" };
+    int abandoned = 0;
+    double seconds = 0;
+    printf("%7s %14s %12s %9s  %s\n", "quantum", names[objective], "clock", "seconds", "status");
+    for(map<int, tuneCandidate>::iterator i = tried.begin(); i != tried.end(); ++i){
+        tuneCandidate &c = i->second;
+        // An abandoned run shows the bound that ruled it out
+        printf("%7d %s%12.2f %12lu %9.3f  %s\n", c.quantum, !c.abandoned ? "  " : objective == TUNE_THROUGHPUT ? "<=" : ">=",
+               valueOf(c), c.clock, c.seconds, c.abandoned ? "abandoned" : "complete");
+        abandoned += c.abandoned;
+        seconds += c.seconds;
+    }
+    if(bestQuantum)
+        printf("Best quantum = %d (%s = %.2f)\n", bestQuantum, names[objective], valueOf(tried[bestQuantum]));
+    printf("Tried %d quanta, abandoned %d early, %.3f seconds of simulation\n", (int)tried.size(), abandoned, seconds);
+}
+
+#endif // TUNER_H_INCLUDED
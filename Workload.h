@@ -0,0 +1,278 @@
+/**
+ * This file contains the synthetic workload generator. It is a job source that makes up jobs as they are read,
+ * so a workload of any size can be simulated (or written to a file) without ever being held in memory.
+ *
+ * A workload is described by a spec of comma separated settings, e.g.
+ *      gen:jobs=1000000,seed=7,bursts=uniform:1:20,length=exp:100,arrival=poisson:25
+ *      jobs    - number of jobs to generate, or inf to never stop generating (default 1000)
+ *      seed    - seed of the random number generator. The same spec always generates the same jobs (default 1)
+ *      bursts  - distribution of the number of CPU bursts per job (default uniform:1:20)
+ *      length  - distribution of the length of each CPU burst (default uniform:1:250)
+ *      arrival - distribution of the time between the arrivals of consecutive jobs (default const:0, all arrive at 0)
+ * Distributions:
+ *      const:v             - always v
+ *      uniform:a:b         - any integer from a to b with equal probability
+ *      exp:mean            - exponential with the given mean (use for arrival to get poisson arrivals)
+ *      poisson:mean        - same as exp:mean
+ *      pareto:alpha:min    - heavy tailed, no less than min. Smaller alpha means a heavier tail
+ * Bursts and burst lengths are never less than 1. Arrival times stop growing once they reach the largest long.
+ *
+ * Requires JobSource.h
+ */
+
+#ifndef WORKLOAD_H_INCLUDED
+#define WORKLOAD_H_INCLUDED
+
+#include "JobSource.h"
+#include <cmath>
+#include <climits>
+#include <cstdlib>
+#include <sstream>
+
+#define DIST_CONST 0
+#define DIST_UNIFORM 1
+#define DIST_EXP 2
+#define DIST_PARETO 3
+
+using namespace std;
+
+/* Pseudo random number generator (xoshiro256**). It is implemented here rather than taken from <random> so that
+ * a seed generates the same workload with every compiler and standard library
+ */
+class Random{
+private:
+    unsigned long long s[4];
+    static unsigned long long rotl(unsigned long long x, int k)    { return (x << k) | (x >> (64 - k)); }
+public:
+    Random(unsigned long long seed = 1)     { setSeed(seed); }
+    void setSeed(unsigned long long seed);
+    unsigned long long next();
+    double uniform()                        { return (next() >> 11) * (1.0/9007199254740992.0); }   // Uniform in [0, 1)
+    void save(SnapshotWriter &out)          { for(int i=0; i<4; i++) out.put(s[i]); }             // Write the state to a snapshot
+    bool load(SnapshotReader &in)           { for(int i=0; i<4; i++) in.get(s[i]); return in.good(); }  // Read the state back from a snapshot
+};
+
+// Function to seed the generator. The state is filled from the seed with splitmix64, as recommended for xoshiro
+void Random::setSeed(unsigned long long seed){
+    for(int i=0; i<4; i++){
+        unsigned long long z = (seed += 0x9e3779b97f4a7c15ULL);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        s[i] = z ^ (z >> 31);
+    }
+}
+
+// Function to generate the next 64 random bits
+unsigned long long Random::next(){
+    unsigned long long result = rotl(s[1] * 5, 7) * 9;
+    unsigned long long t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return result;
+}
+
+// Distribution of a random integer
+struct distribution{
+    int kind;
+    double a, b;
+};
+
+inline bool operator==(const distribution &x, const distribution &y){
+    return x.kind == y.kind && x.a == y.a && x.b == y.b;
+}
+
+/* Function to parse a distribution (e.g. "uniform:1:20")
+ * Returns false if the text is not a valid distribution
+ */
+bool parseDistribution(string text, distribution &d){
+    // Split the text into the name and up to two parameters
+    string name, params[2];
+    int nParams = 0;
+    size_t colon = text.find(':');
+    name = text.substr(0, colon);
+    while(colon != string::npos && nParams < 2){
+        size_t nextColon = text.find(':', colon + 1);
+        params[nParams++] = text.substr(colon + 1, nextColon == string::npos ? string::npos : nextColon - colon - 1);
+        colon = nextColon;
+    }
+    if(colon != string::npos)
+        return false;
+
+    d.a = nParams > 0 ? atof(params[0].c_str()) : 0;
+    d.b = nParams > 1 ? atof(params[1].c_str()) : 0;
+    if(name == "const" && nParams == 1)
+        d.kind = DIST_CONST;
+    else if(name == "uniform" && nParams == 2 && d.a <= d.b)
+        d.kind = DIST_UNIFORM;
+    else if((name == "exp" || name == "poisson") && nParams == 1 && d.a > 0)
+        d.kind = DIST_EXP;
+    else if(name == "pareto" && nParams == 2 && d.a > 0 && d.b > 0)
+        d.kind = DIST_PARETO;
+    else
+        return false;
+    return true;
+}
+
+// Function to draw a value from a distribution, rounded to an integer and limited to the range of int
+long sample(distribution &d, Random &rng){
+    double x;
+    switch(d.kind){
+    case DIST_UNIFORM:
+        x = floor(d.a + rng.uniform()*(d.b - d.a + 1));
+        break;
+    case DIST_EXP:
+        x = floor(-d.a*log(1 - rng.uniform()) + 0.5);
+        break;
+    case DIST_PARETO:
+        x = floor(d.b / pow(1 - rng.uniform(), 1/d.a));
+        break;
+    default:
+        x = d.a;
+    }
+    return x > INT_MAX ? INT_MAX : (long)x;
+}
+
+// Job source generating a synthetic workload
+class WorkloadGenerator : public JobSource{
+private:
+    long jobs, generated, arrival;
+    unsigned long long seed;
+    distribution burstDist, lengthDist, arrivalDist;
+    Random rng;
+    vector<int> bursts;         // Bursts of the last job generated (reused for every job)
+public:
+    WorkloadGenerator();
+    bool setSpec(string spec);
+    bool done()                 { return generated >= jobs; }
+    bool next(jobRecord &job);
+    bool endless()              { return jobs == LONG_MAX; }
+    bool saveState(SnapshotWriter &out);
+    bool loadState(SnapshotReader &in);
+};
+
+// Default class constructor (the default workload, see the top of this file)
+WorkloadGenerator::WorkloadGenerator(){
+    jobs = 1000;
+    generated = 0;
+    arrival = 0;
+    seed = 1;
+    parseDistribution("uniform:1:20", burstDist);
+    parseDistribution("uniform:1:250", lengthDist);
+    parseDistribution("const:0", arrivalDist);
+    rng.setSeed(seed);
+}
+
+/* Function to set up the generator from a workload spec (with or without the gen: prefix)
+ * Returns false if the spec is invalid
+ */
+bool WorkloadGenerator::setSpec(string spec){
+    if(spec.compare(0, 4, "gen:") == 0)
+        spec = spec.substr(4);
+
+    istringstream settings(spec);
+    string setting;
+    while(getline(settings, setting, ',')){
+        size_t eq = setting.find('=');
+        if(eq == string::npos)
+            return false;
+        string key = setting.substr(0, eq), value = setting.substr(eq + 1);
+
+        if(key == "jobs")
+            jobs = value == "inf" ? LONG_MAX : atol(value.c_str());
+        else if(key == "seed")
+            seed = strtoull(value.c_str(), NULL, 10);
+        else if(key == "bursts"){
+            if(!parseDistribution(value, burstDist))
+                return false;
+        }
+        else if(key == "length"){
+            if(!parseDistribution(value, lengthDist))
+                return false;
+        }
+        else if(key == "arrival"){
+            if(!parseDistribution(value, arrivalDist))
+                return false;
+        }
+        else
+            return false;
+    }
+
+    // Start generating from the beginning of the new workload
+    generated = 0;
+    arrival = 0;
+    rng.setSeed(seed);
+    return jobs >= 0;
+}
+
+// Function to generate the next job
+bool WorkloadGenerator::next(jobRecord &job){
+    if(done())
+        return false;
+
+    // The first job arrives at time 0, each one after that some time after the previous one
+    if(generated){
+        long gap = max(0L, sample(arrivalDist, rng));
+        arrival = arrival > LONG_MAX - gap ? LONG_MAX : arrival + gap;
+    }
+
+    job.id = generated++;
+    job.arrivalTime = arrival;
+    job.numBursts = max(1L, sample(burstDist, rng));
+    bursts.resize(job.numBursts);
+    for(int i=0; i<job.numBursts; i++)
+        bursts[i] = max(1L, sample(lengthDist, rng));
+    job.bursts = bursts.data();
+    return true;
+}
+
+// Function to write the spec, the number of jobs generated so far and the state of the generator to a snapshot
+bool WorkloadGenerator::saveState(SnapshotWriter &out){
+    out.put((int)SOURCE_GENERATOR);
+    out.put(jobs);
+    out.put(seed);
+    out.put(burstDist);
+    out.put(lengthDist);
+    out.put(arrivalDist);
+    out.put(generated);
+    out.put(arrival);
+    rng.save(out);
+    return true;
+}
+
+// Function to continue generating from the state in a snapshot, which must have been taken with the same spec
+bool WorkloadGenerator::loadState(SnapshotReader &in){
+    int kind;
+    long savedJobs;
+    unsigned long long savedSeed;
+    distribution savedBursts, savedLength, savedArrival;
+    if(!(in.get(kind) && in.get(savedJobs) && in.get(savedSeed) && in.get(savedBursts) && in.get(savedLength) &&
+         in.get(savedArrival)) || kind != SOURCE_GENERATOR || savedJobs != jobs || savedSeed != seed ||
+       !(savedBursts == burstDist && savedLength == lengthDist && savedArrival == arrivalDist))
+        return false;
+    return in.get(generated) && in.get(arrival) && rng.load(in);
+}
+
+// Function to check if a job file name is a workload spec
+bool isWorkloadSpec(string name){
+    return name.compare(0, 4, "gen:") == 0;
+}
+
+/* Function to open the jobs to simulate: a generated workload if the name is a workload spec, otherwise a job file
+ * Returns NULL if the spec is invalid or the file can't be opened. The caller owns the returned source
+ */
+JobSource *openJobs(string name){
+    if(!isWorkloadSpec(name))
+        return openJobSource(name);
+
+    WorkloadGenerator *gen = new WorkloadGenerator();
+    if(gen->setSpec(name))
+        return gen;
+    delete gen;
+    return NULL;
+}
+
+#endif // WORKLOAD_H_INCLUDED
@@ -0,0 +1,124 @@
+//***************************************************************************************
+// Benchmark of the simulator's throughput
+// @params: [--sizes=<n,n,...>] [--max-jobs=<n,n,...>] [--quantum=<q>] [--engine=tick|event] [--workload=<spec>]
+//          [--sample-interval=<t>]
+//
+// Runs FCFS, SJF and RR over generated workloads of increasing size (number of jobs) and resident-set size
+// (number of jobs that fit in memory at a time) and prints one CSV row per run:
+//      policy,engine,jobs,max_jobs,load_s,simulate_s,report_s,jobs_per_s,events_per_s,events,clock,peak_rss_kb
+// load is generating the workload into memory, simulate is the scheduling loop and report is formatting the
+// summary statistics. peak_rss_kb is the peak resident set size of the benchmark process so far.
+// With --sample-interval every run also records the state of the CPU every t units of time (check Sampler.h), to measure
+// the cost of sampling.
+// Required files to run: CPU.h, stats.h, PCB.h, policy.h, scheduler.h, ReadyQueue.h, JobSource.h, Workload.h, Sweep.h,
+//                        Histogram.h, Sampler.h, TraceWriter.h, Pipeline.h, SPSCRing.h, Overhead.h
+//***************************************************************************************
+
+#include <chrono>
+#include <cstdio>
+#include <sys/resource.h>
+#include "CPU.h"
+#include "Workload.h"
+#include "policy.h"
+#include "scheduler.h"
+#include "Sweep.h"
+
+using namespace std;
+
+// Function to read the time in seconds from an arbitrary starting point
+double now(){
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Function to read the peak resident set size of this process in kilobytes
+long peakRSS(){
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* Function to simulate one policy over a workload already loaded into memory and print its CSV row
+ * @param: trace - the workload in the binary trace format, without the header
+           loadTime - time it took to generate the workload
+*/
+template <class Policy>
+void benchPolicy(const char *name, Policy policy, vector<int> &trace, long jobs, int maxJobs, bool eventDriven, double loadTime,
+                 unsigned long sampleInterval){
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    CPU myCPU(maxJobs);
+    stats myStats;
+    myCPU.setVerbose(false);
+    Sampler sampler(sampleInterval, sampleInterval ? SAMPLE_CAPACITY : 1);
+    if(sampleInterval)
+        myCPU.setSampler(&sampler);
+
+    double start = now();
+    runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    double simulated = now();
+    ostringstream report;
+    report << "CPU clock value = " << myCPU.getCPUTime() << endl;
+    myStats.printStats(report);
+    double reported = now();
+
+    double simTime = simulated - start;
+    printf("%s,%s,%ld,%d,%.6f,%.6f,%.6f,%.0f,%.0f,%lu,%lu,%ld\n", name, eventDriven ? "event" : "tick", jobs, maxJobs,
+           loadTime, simTime, reported - simulated, jobs/simTime, myCPU.getEvents()/simTime, myCPU.getEvents(),
+           myCPU.getCPUTime(), peakRSS());
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    vector<long> sizes = parseList("1000,10000,100000,1000000");
+    vector<long> memorySizes = parseList("10,100,1000");
+    int quantum = 20;
+    bool eventDriven = true;
+    string workload = "gen:seed=1";
+    unsigned long sampleInterval = 0;      // No sampling
+
+    for(int i=1; i<argc; i++){
+        string arg(argv[i]);
+        if(arg.compare(0, 8, "--sizes=") == 0)
+            sizes = parseList(arg.substr(8));
+        else if(arg.compare(0, 11, "--max-jobs=") == 0)
+            memorySizes = parseList(arg.substr(11));
+        else if(arg.compare(0, 10, "--quantum=") == 0)
+            quantum = atoi(arg.substr(10).c_str());
+        else if(arg == "--engine=event")
+            eventDriven = true;
+        else if(arg == "--engine=tick")
+            eventDriven = false;
+        else if(arg.compare(0, 11, "--workload=") == 0)
+            workload = arg.substr(11);
+        else if(arg.compare(0, 18, "--sample-interval=") == 0)
+            sampleInterval = strtoul(arg.substr(18).c_str(), NULL, 10);
+        else{
+            cout << "Usage: [--sizes=<n,n,...>] [--max-jobs=<n,n,...>] [--quantum=<q>] [--engine=tick|event] [--workload=<spec>]\n";
+            cout << "       [--sample-interval=<t>]\n";
+            return -1;
+        }
+    }
+
+    printf("policy,engine,jobs,max_jobs,load_s,simulate_s,report_s,jobs_per_s,events_per_s,events,clock,peak_rss_kb\n");
+    for(size_t i=0; i<sizes.size(); i++){
+        // Load: generate the workload into memory once, every run over it reads the same jobs
+        double start = now();
+        WorkloadGenerator gen;
+        ostringstream spec;
+        spec << workload << ",jobs=" << sizes[i];
+        if(!gen.setSpec(spec.str())){
+            cout << "Invalid workload spec\n";
+            return -1;
+        }
+        vector<int> trace;
+        readTrace(gen, trace);
+        double loadTime = now() - start;
+
+        for(size_t j=0; j<memorySizes.size(); j++){
+            benchPolicy("FCFS", FCFSPolicy(), trace, sizes[i], memorySizes[j], eventDriven, loadTime, sampleInterval);
+            benchPolicy("SJF", SJFPolicy(), trace, sizes[i], memorySizes[j], eventDriven, loadTime, sampleInterval);
+            benchPolicy("RR", RRPolicy(quantum), trace, sizes[i], memorySizes[j], eventDriven, loadTime, sampleInterval);
+        }
+    }
+    return 0;
+}
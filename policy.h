@@ -0,0 +1,200 @@
+/**
+ * This file contains the scheduling policies that can be plugged into the simulation core (see scheduler.h).
+ *
+ * A policy is any class providing the following members. They are resolved at compile time, so each policy
+ * gets its own specialized copy of the simulation loop and hooks it doesn't need compile away to nothing.
+ *      static const bool printsState       - print the CPU state every PRINT_INTERVAL units of time
+ *      static const bool preemptsOnReady   - can a job entering the ready queue preempt the running job?
+ *      const char *name()                  - header printed before the summary statistics
+ *      bool init(CPU &cpu)                 - configure the CPU before the simulation starts (false if invalid)
+ *      void onDispatch(CPU &cpu)           - called before the job at the front of the ready queue is examined
+ *      bool preempt(CPU &cpu, PCB &job)    - should the running job be preempted before its next unit of time?
+ *      int  sliceLength(CPU &cpu, PCB &job)- units of time the job can run before preempt() must be checked again
+ *      void onBlock(CPU &cpu)              - called after the running job has been moved to the IO blocked queue
+ *      void onComplete(CPU &cpu)           - called after the running job has completed
+ *
+ * Requires CPU.h
+ */
+
+#ifndef POLICY_H_INCLUDED
+#define POLICY_H_INCLUDED
+
+#include "CPU.h"
+#include <vector>
+#include <string>
+#include <sstream>
+
+#define MLFQ_LEVELS 3           // Levels of MLFQ when only the quantum of the top level is given
+
+// First come first serve: jobs run in the order they enter the ready queue, without preemption
+class FCFSPolicy{
+public:
+    static const bool printsState = true;
+    static const bool preemptsOnReady = false;
+    const char *name()                      { return "FCFS\n"; }
+    bool init(CPU &cpu)                     { cpu.setReadyOrder(ORDER_FIFO); return true; }
+    void onDispatch(CPU &)                  { }
+    bool preempt(CPU &, PCB &)              { return false; }
+    int  sliceLength(CPU &, PCB &job)       { return job.getBurstRemaining(); }
+    void onBlock(CPU &)                     { }
+    void onComplete(CPU &)                  { }
+};
+
+// Shortest job first: the job with the shortest current burst runs next, without preemption
+// The ready queue keeps itself in shortest burst order, so there's nothing to do at dispatch
+class SJFPolicy{
+public:
+    static const bool printsState = false;
+    static const bool preemptsOnReady = false;
+    const char *name()                      { return "SJF:\n"; }
+    bool init(CPU &cpu)                     { cpu.setReadyOrder(ORDER_SHORTEST); return true; }
+    void onDispatch(CPU &)                  { }
+    bool preempt(CPU &, PCB &)              { return false; }
+    int  sliceLength(CPU &, PCB &job)       { return job.getBurstRemaining(); }
+    void onBlock(CPU &)                     { }
+    void onComplete(CPU &)                  { }
+};
+
+// Round robin: first come first serve, but the running job is preempted once it uses up its time quantum
+class RRPolicy{
+private:
+    int quantum;
+public:
+    static const bool printsState = false;
+    static const bool preemptsOnReady = false;
+    RRPolicy(int q)                         { quantum = q; }
+    const char *name()                      { return "RR\n"; }
+    bool init(CPU &cpu)                     { cpu.setReadyOrder(ORDER_FIFO); return cpu.writeQuantum(quantum); }
+    void onDispatch(CPU &)                  { }
+    void onBlock(CPU &)                     { }
+    void onComplete(CPU &)                  { }
+
+    // If the time quantum expired, preempt this job and add it to the end of the ready queue
+    // (a job resumed from a snapshot taken with another policy may already have run for longer than the quantum)
+    bool preempt(CPU &cpu, PCB &job)        { return job.getCurrentQuantumTime() >= cpu.getQuantum(); }
+
+    // Run until the burst completes or the time quantum expires, whichever comes first
+    int sliceLength(CPU &cpu, PCB &job){
+        return max(1, min(job.getBurstRemaining(), cpu.getQuantum() - job.getCurrentQuantumTime()));
+    }
+};
+
+// Shortest remaining time first: the job whose current burst has the least time left runs next, and a job entering the
+// ready queue with less time left than the running job preempts it
+class SRTFPolicy{
+public:
+    static const bool printsState = false;
+    static const bool preemptsOnReady = true;
+    const char *name()                      { return "SRTF\n"; }
+    bool init(CPU &cpu)                     { cpu.setReadyOrder(ORDER_REMAINING); return true; }
+    void onDispatch(CPU &)                  { }
+    bool preempt(CPU &cpu, PCB &job)        { return cpu.nextReadyKey() < job.getBurstRemaining(); }
+    int  sliceLength(CPU &, PCB &job)       { return job.getBurstRemaining(); }
+    void onBlock(CPU &)                     { }
+    void onComplete(CPU &)                  { }
+};
+
+/* Multi-level feedback queue: jobs start at level 0 and run round robin with the quantum of their level. A job that uses
+ * up its whole quantum moves down one level (the last level keeps it), and a job that blocks for IO first keeps its level
+ * A job only runs if no job is ready at a higher level, and a job entering the ready queue at a higher level than the
+ * running job preempts it
+ */
+class MLFQPolicy{
+private:
+    vector<int> quanta;     // Quantum of each level, from the highest level (0) to the lowest
+public:
+    static const bool printsState = false;
+    static const bool preemptsOnReady = true;
+    MLFQPolicy(vector<int> q)               { quanta = q; }
+    const char *name()                      { return "MLFQ\n"; }
+    void onDispatch(CPU &)                  { }
+    void onBlock(CPU &)                     { }
+    void onComplete(CPU &)                  { }
+
+    // There must be at least one level, and every quantum must be positive
+    bool init(CPU &cpu){
+        if(quanta.empty() || *min_element(quanta.begin(), quanta.end()) <= 0)
+            return false;
+        cpu.setReadyOrder(ORDER_LEVEL);
+        return true;
+    }
+
+    // Level whose quantum the job runs with (a job resumed from a snapshot taken with more levels runs at the lowest one)
+    int levelOf(PCB &job)                   { return min(job.getLevel(), (int)quanta.size() - 1); }
+
+    // If the quantum of its level expired, move this job down a level and preempt it. Otherwise only preempt it for a job at a higher level
+    bool preempt(CPU &cpu, PCB &job){
+        if(job.getCurrentQuantumTime() >= quanta[levelOf(job)]){
+            job.setLevel(min(levelOf(job) + 1, (int)quanta.size() - 1));
+            return true;
+        }
+        return cpu.nextReadyKey() < job.getLevel();
+    }
+
+    // Run until the burst completes or the quantum of the job's level expires, whichever comes first
+    int sliceLength(CPU &, PCB &job){
+        return max(1, min(job.getBurstRemaining(), quanta[levelOf(job)] - job.getCurrentQuantumTime()));
+    }
+};
+
+// Function to build the quanta of MLFQ levels from the quantum of the top level, each level with twice the quantum of the level above
+vector<int> levelQuanta(int quantum, int levels = MLFQ_LEVELS){
+    vector<int> quanta;
+    for(int i=0; i<levels; i++)
+        quanta.push_back(i ? (int)min(2L*quanta.back(), (long)INT_MAX) : quantum);
+    return quanta;
+}
+
+/* Function to parse the quanta of MLFQ levels, highest first. A list (q,q,...) gives the quantum of every level, and a
+ * single quantum gives that many levels, starting with it (check levelQuanta())
+ */
+vector<int> parseLevelQuanta(string text, int levels = MLFQ_LEVELS){
+    vector<int> quanta;
+    istringstream items(text);
+    string item;
+    while(getline(items, item, ','))
+        quanta.push_back(atoi(item.c_str()));
+    return quanta.size() == 1 ? levelQuanta(quanta[0], levels) : quanta;
+}
+
+/* Priority scheduling with aging: the job with the highest priority runs next (priorities come from job IDs, look at
+ * CPU::setPriorities()). For every aging units of time a job waits in the ready queue it is treated as one priority higher,
+ * and the running job is preempted as soon as a waiting job's aged priority is higher than its own
+ */
+class PriorityPolicy{
+private:
+    long aging;
+    int levels;
+public:
+    static const bool printsState = false;
+    static const bool preemptsOnReady = true;
+    PriorityPolicy(long a, int l = PRIORITY_LEVELS) { aging = a; levels = l; }
+    const char *name()                      { return "PRIO\n"; }
+    void onDispatch(CPU &)                  { }
+    void onBlock(CPU &)                     { }
+    void onComplete(CPU &)                  { }
+
+    // The priorities must be set before the ready queue is ordered by them
+    bool init(CPU &cpu){
+        if(!cpu.setPriorities(levels, aging))
+            return false;
+        cpu.setReadyOrder(ORDER_PRIORITY);
+        return true;
+    }
+
+    // Does the waiting job with the highest aged priority outrank the running job (which doesn't age while it runs)?
+    bool preempt(CPU &cpu, PCB &job){
+        long next = cpu.nextReadyKey();
+        return next != LONG_MAX && next + aging <= cpu.priorityKey(job, cpu.getCPUTime());
+    }
+
+    // Run until the burst completes or a waiting job ages past the running job, whichever comes first
+    int sliceLength(CPU &cpu, PCB &job){
+        long next = cpu.nextReadyKey();
+        if(next == LONG_MAX)
+            return job.getBurstRemaining();
+        return min((long)job.getBurstRemaining(), next + aging - cpu.priorityKey(job, cpu.getCPUTime()));
+    }
+};
+
+#endif // POLICY_H_INCLUDED
@@ -0,0 +1,179 @@
+/**
+ * This file contains the simulation core shared by every scheduling policy (policies are defined in policy.h).
+ *
+ * Requires CPU.h, stats.h, policy.h, Pipeline.h
+ */
+
+#ifndef SCHEDULER_H_INCLUDED
+#define SCHEDULER_H_INCLUDED
+
+#include "CPU.h"
+#include "policy.h"
+#include "Pipeline.h"
+
+/**
+ * runSimulation - Simulates a scheduling policy in a virtual single processor CPU, until every job is complete
+ * @param: JobQ - source the jobs are read from as they are loaded into memory (check JobSource.h)
+           policy - decides which job runs next and when the running job is preempted (check policy.h)
+           myCPU - virtual CPU to run the jobs on (check CPU.h)
+           myStats - collects the statistics of every job completed
+           EventDriven - jump the clock from one event to the next instead of ticking one unit at a time
+ * Prints CPU stats every 200 units of CPU time if the policy asks for it and the CPU is verbose
+ * Returns false if the policy rejected its parameters (e.g. non-positive time quantum)
+*/
+template <class Policy, bool EventDriven>
+bool runSimulation(JobSource &JobQ, Policy &policy, CPU &myCPU, stats &myStats){
+    if(!policy.init(myCPU))
+        return false;
+    bool printState = Policy::printsState && myCPU.isVerbose();
+
+    // We need to run the CPU as long as there are pending jobs in the queue or memory, until the stop time
+    while((myCPU.memoryUsed() || myCPU.pendingJob() || !JobQ.done()) && !myCPU.stopped()){
+
+        // Insert jobs into the ready queue if memory permits
+        while(myCPU.insertToReady(&JobQ));
+
+        // Pay the overhead the CPU owes (context switches, admissions, ... check Overhead.h) before any job runs
+        if(myCPU.owesOverhead()){
+            if(EventDriven)
+                myCPU.payOverheadFor(printState);
+            else{
+                myCPU.payOverhead();
+                if(printState && myCPU.getCPUTime()%PRINT_INTERVAL == 0)
+                    myCPU.printCPUState();
+            }
+            continue;
+        }
+
+        // If all jobs in memory are waiting for IO
+        if(!myCPU.readyJobs()){
+            // There may be none left at all, if reading stopped at a malformed job (check JobSource.h)
+            if(!myCPU.memoryUsed() && !myCPU.pendingJob() && JobQ.done())
+                break;
+            if(EventDriven)
+                myCPU.idleUntilEvent();
+            else
+                myCPU.incCPUTime();
+            continue;
+        }
+
+        // Let the policy pick the job to run next
+        policy.onDispatch(myCPU);
+
+        PCB currentJob = myCPU.getCurrentJob();
+        // If this burst cycle is complete
+        if(currentJob.getCurrentBurstPC() == currentJob.getThisBurst()){
+
+            // Was this the last burst cycle? If yes, the process is complete
+            if(currentJob.getCurrentBurstNum() == currentJob.getNumBursts()){
+                myStats.addStats(myCPU.completeJob());  // Complete job and record stats for summary at end of simulation
+                policy.onComplete(myCPU);
+            }
+
+            // The process is blocking for IO
+            else{
+                myCPU.insertToIOBlock();
+                policy.onBlock(myCPU);
+            }
+            continue;
+        }
+
+        // Does the policy want to take the CPU away from this job?
+        else if(policy.preempt(myCPU, currentJob)){
+            myCPU.preemptJob();
+            continue;
+        }
+
+        // Giving the CPU to this job may cost overhead, which is paid before it runs
+        else if(myCPU.dispatch())
+            continue;
+
+        // Run until the burst completes or the policy has to be asked again, in one step
+        else if(EventDriven){
+            myCPU.serviceJobFor(policy.sliceLength(myCPU, currentJob), printState, Policy::preemptsOnReady);
+            continue;
+        }
+        // This burst cycle isn't complete, so continue processing it
+        else
+            myCPU.serviceJob();
+
+        // Increment CPU clock by 1 and check if any jobs finished IO
+        myCPU.incCPUTime();
+
+        // Print state of CPU every 200 units of time
+        if(printState && myCPU.getCPUTime()%PRINT_INTERVAL == 0 && myCPU.getCPUTime())
+            myCPU.printCPUState();
+    }
+    return true;
+}
+
+// Function to run a policy with the engine selected at run time
+template <class Policy>
+bool runSimulation(JobSource &JobQ, Policy &policy, CPU &myCPU, stats &myStats, bool eventDriven){
+    if(eventDriven)
+        return runSimulation<Policy, true>(JobQ, policy, myCPU, myStats);
+    return runSimulation<Policy, false>(JobQ, policy, myCPU, myStats);
+}
+
+/* Function to run the policy with the given name (FCFS, SJF, SRTF, RR, MLFQ or PRIO) when the policy is only known at run time
+ * quantum is the time quantum of RR, the quantum of the top level of MLFQ (which has levels levels, each with twice the
+ * quantum of the level above) and the aging interval of PRIO
+ * Returns false if the name is not a policy or the policy rejected its parameters
+ */
+bool runPolicy(string name, int quantum, JobSource &JobQ, CPU &myCPU, stats &myStats, bool eventDriven,
+               int levels = MLFQ_LEVELS){
+    if(name == "FCFS"){
+        FCFSPolicy policy;
+        return runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    }
+    if(name == "SJF"){
+        SJFPolicy policy;
+        return runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    }
+    if(name == "SRTF"){
+        SRTFPolicy policy;
+        return runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    }
+    if(name == "RR"){
+        RRPolicy policy(quantum);
+        return runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    }
+    if(name == "MLFQ"){
+        MLFQPolicy policy(levelQuanta(quantum, levels));
+        return runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    }
+    if(name == "PRIO"){
+        PriorityPolicy policy(quantum);
+        return runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    }
+    return false;
+}
+
+/* Function to simulate a policy on a CPU and print the summary statistics at the end of simulation
+ * The statistics of the jobs completed are added to myStats (which already holds those of a restored snapshot, if any)
+ * If pipelined, the jobs are read and the completed jobs reported on threads of their own (check Pipeline.h)
+ * Returns false if the policy rejected its parameters
+ */
+template <class Policy>
+bool simulate(JobSource &JobQ, Policy policy, CPU &myCPU, stats &myStats, bool eventDriven, bool pipelined = false){
+    bool valid;
+    if(pipelined){
+        Pipeline pipe(JobQ, myCPU);
+        valid = runSimulation(pipe.jobs(), policy, myCPU, myStats, eventDriven);
+        pipe.finish();          // Everything reported is printed before the summary
+    }
+    else
+        valid = runSimulation(JobQ, policy, myCPU, myStats, eventDriven);
+    if(!valid){
+        cout << "Invalid time quantum!";
+        return false;
+    }
+
+    // Print summary statistics of simulation
+    cout << policy.name();
+    cout << "CPU clock value = " << myCPU.getCPUTime() << endl;
+    myStats.printStats();
+    return true;
+}
+
+#endif // SCHEDULER_H_INCLUDED
@@ -2,253 +2,460 @@
 // Author : Prahar Ijner
 // CSCI 375 - Operating Systems
 // Programming assignment 1
-// @params: <algorithm> [time quantum if algorithm == RR] <File name for Jobs>
+// @params: <algorithm> [time quantum if algorithm == RR] <File name for Jobs> [--engine=tick|event] [--cores=n] [--max-jobs=n]
+//          (the algorithm can also be SRTF, MLFQ with a quantum per level (q,q,...) or PRIO with an aging interval)
+//                [--quiet] [--results=<file> [--results-format=csv|binary]] [--arrivals] [--until=<time>]
+//                [--io-devices=n] [--io-time=t|t,t,...] [--save=<file>] [--resume=<file>]
+//                [--samples=<file> [--sample-interval=t] [--sample-capacity=n] [--samples-format=csv|binary]] [--trace=<file>]
+//                [--pipeline] [--overhead=<spec>] [--priorities=n] [--levels=n]
+//                [--nodes=n [--dispatcher=rr|least-loaded|p2c] [--window=t] [--threads=n] [--node-stats=<file>]]
+//      or: convert <text file name for Jobs> <binary file name for Jobs>
+//      or: gen <workload spec> <file name for Jobs> [--format=text|binary]
+//      or: sweep <File name for Jobs> [--quanta=q,q,...] [--max-jobs=n,n,...] [--io-time=t,t,...] [--threads=n]
+//                [--overhead=<spec>] [--levels=n]
+//      or: tune <File name for Jobs> [--objective=wait|p99-wait|turnaround|p99-turnaround|throughput]
+//                [--quanta=low:high|q,q,...] [--max-jobs=n] [--io-time=t] [--threads=n] [--overhead=<spec>] [--arrivals]
+// The file name for Jobs can also be a workload spec (gen:...), to simulate a generated workload (check Workload.h),
+// or -, to read jobs from stdin as they are needed
+// --save writes a snapshot of the simulation when it stops (e.g. at --until), and --resume continues the simulation from
+// a snapshot, with the same job file (check CPU::saveSnapshot())
+// --samples records the queue lengths and CPU counters every sample interval and writes them as a time series (check Sampler.h)
+// --trace writes every CPU shot, IO operation and preemption as a Chrome trace (check TraceWriter.h)
+// --overhead charges CPU time for context switches, dispatches, admissions and IO system calls (check Overhead.h)
+// --priorities sets the number of priorities of PRIO, and --levels the number of levels of MLFQ given a single quantum
+// (1 by default, 3 in a sweep), each with twice the quantum of the level above (check levelQuanta() in policy.h)
+// tune searches for the RR time quantum that is best at an objective, trying quanta in parallel (check Tuner.h)
+// --pipeline reads the jobs and prints the completed jobs on threads of their own while simulating (check Pipeline.h)
+// --nodes simulates a fleet of CPUs behind a dispatcher, in parallel on several threads (check Cluster.h)
 //
-// This program simulates FCFS, SJF, and RR scheduling on a virtual single processor CPU
-// Required files to run: CPU.h, stats.h, PCB.h
+// This program simulates FCFS, SJF, SRTF, RR, MLFQ and priority scheduling on a virtual single processor CPU
+// Required files to run: CPU.h, stats.h, PCB.h, policy.h, scheduler.h, ReadyQueue.h, JobSource.h, Workload.h, Sweep.h,
+//                        MultiCore.h, Histogram.h, ResultsWriter.h, IOSubsystem.h, Snapshot.h, Sampler.h, TraceWriter.h,
+//                        Pipeline.h, SPSCRing.h, Overhead.h, Tuner.h, Cluster.h
 //***************************************************************************************
 
 
-#include <fstream>
-#include <sstream>
+#include <map>
 #include "CPU.h"
+#include "Workload.h"
+#include "policy.h"
+#include "scheduler.h"
+#include "Sweep.h"
+#include "Tuner.h"
+#include "MultiCore.h"
+#include "Cluster.h"
 
 using namespace std;
 
-void FCFS(queue<string>);           // Function to perform first come first serve scheduling
-void SJF(queue<string>);            // Function to perform shortest job first scheduling
-void RR(queue<string>, int );       // Function to perform round robin scheduling
+// Options accepted on the command line (--name=value)
+const char *knownOptions[] = { "engine", "format", "quanta", "max-jobs", "io-time", "threads", "cores", "quiet", "results",
+                              "results-format", "arrivals", "until", "io-devices",
+                              "priorities", "save", "resume", "samples", "sample-interval", "sample-capacity",
+                              "samples-format", "trace", "pipeline", "overhead", "objective", "nodes", "dispatcher",
+                              "window", "node-stats", "levels" };
 
 int main(int argc, char *argv[])
 {
 
-    string algorithm, filename;
+    string algorithm, filename, qText;
     int q = 0;
-    // If the user enters wrong command line parameters
-    if(argc > 4 || argc < 3){
-        cout << "Invalid parameters\n";
-        cout << "Usage: <algorithm> <JobQueue file name>\n";
-        return -1;
+
+    // Separate the options (--name=value) from the positional parameters
+    map<string, string> options;
+    vector<string> params;
+    for(int i=1; i<argc; i++){
+        string arg(argv[i]);
+        if(arg.compare(0, 2, "--") == 0){
+            size_t eq = arg.find('=');
+            string name = arg.substr(2, eq == string::npos ? string::npos : eq - 2);
+            if(find(knownOptions, knownOptions + sizeof(knownOptions)/sizeof(*knownOptions), name)
+               == knownOptions + sizeof(knownOptions)/sizeof(*knownOptions)){
+                cout << "Unknown option " << arg << "\n";
+                return -1;
+            }
+            options[name] = eq == string::npos ? "" : arg.substr(eq + 1);
+        }
+        else
+            params.push_back(arg);
     }
 
-    // Round robin scheduling requires an extra parameter (time quantum)
-    else if(argc == 4){
-        algorithm = string(argv[1]);
-        filename = string(argv[3]);
-        q = atoi(argv[2]);
+    // Tick the clock one unit at a time unless the event driven engine is requested
+    if(options.count("engine") && options["engine"] != "tick" && options["engine"] != "event"){
+        cout << "Invalid engine. Available options: tick, event\n";
+        return -1;
     }
-    // FCFS or SJF
-    else{
-        algorithm = string(argv[1]);
-        filename = string(argv[2]);
+    bool eventDriven = options["engine"] == "event";
+    bool binaryFormat = options["format"] == "binary";  // Format of the job file written by gen
+    bool quiet = options.count("quiet") > 0;            // Print only the summary at the end of simulation
+    bool admitOnArrival = options.count("arrivals") > 0;    // Only admit jobs once the clock reaches their arrival time
+    int levels = options.count("levels") ? atoi(options["levels"].c_str()) : 1;    // Levels of MLFQ given a single quantum
+    unsigned long stopTime = options.count("until") ? strtoul(options["until"].c_str(), NULL, 10) : ULONG_MAX;
+    if(options.count("results-format") && options["results-format"] != "csv" && options["results-format"] != "binary"){
+        cout << "Invalid results format. Available options: csv, binary\n";
+        return -1;
+    }
+    if(options.count("samples-format") && options["samples-format"] != "csv" && options["samples-format"] != "binary"){
+        cout << "Invalid samples format. Available options: csv, binary\n";
+        return -1;
+    }
+    // Cost in CPU time of context switches, dispatches, admissions and IO system calls (none by default)
+    Overhead overhead;
+    if(options.count("overhead") && !overhead.setSpec(options["overhead"])){
+        cout << "Invalid overhead spec\n";
+        return -1;
     }
 
-    // Queue to hold all the jobs
-    queue<string> JobQueue;
-
-    ifstream JobQueueFile(filename);
-    string currJob;
-
-    // Read the jobs file and populate the JobQueue
-    while(getline(JobQueueFile, currJob))
-        JobQueue.push(currJob);
-
-    // Call functions based on algorithm selected
-    if(algorithm == "FCFS")
-        FCFS(JobQueue);
-    else if(algorithm == "SJF")
-        SJF(JobQueue);
-    else if(algorithm == "RR")
-        RR(JobQueue, q);        // Note : the RR function will take care of invalid time quantum
-    else
-        cout << "Invalid algorithm name. Available options: FCFS, SJF, RR";
-
-    return 0;
-}
-
-/**
- * FCFS - Simulates a First Come First Serve algorithm in a virtual single processor CPU
- * @param: JobQ - contains a queue of strings describing a job
-           Format of each job in JobQ:
-                <ID> <ArrivalTime> <NumberOfBursts> <n numbers denoting length of each burst>
- * Prints CPU stats every 200 units of CPU time and summary stats at the end of simulation
-*/
-void FCFS(queue<string> JobQ){
-    CPU myCPU;                          // Create virtual CPU (check CPU.h for implementation)
-    stats myStats;                      // Create an object to hold the run time statistics
-
-    // We need to run the CPU as long as there are pending jobs in the queue or memory
-    while(myCPU.memoryUsed() || JobQ.size()){
-
-        // Insert jobs into the ready queue if memory permits
-        while(myCPU.insertToReady(&JobQ));
+    // If the user enters wrong command line parameters
+    if(params.size() > 3 || params.size() < 2){
+        cout << "Invalid parameters\n";
+        cout << "Usage: <algorithm> [time quantum] <JobQueue file name> [--engine=tick|event] [--cores=n] [--max-jobs=n]\n";
+        cout << "                  [--quiet] [--results=<file> [--results-format=csv|binary]] [--arrivals] [--until=<time>]\n";
+        cout << "                  [--io-devices=n] [--io-time=t|t,t,...] [--save=<file>] [--resume=<file>]\n";
+        cout << "                  [--samples=<file> [--sample-interval=t] [--sample-capacity=n] [--samples-format=csv|binary]]\n";
+        cout << "                  [--trace=<file>] [--pipeline] [--overhead=<spec>] [--priorities=n] [--levels=n]\n";
+        cout << "                  [--nodes=n [--dispatcher=rr|least-loaded|p2c] [--window=t] [--threads=n] [--node-stats=<file>]]\n";
+        cout << "       convert <text JobQueue file name> <binary JobQueue file name>\n";
+        cout << "       gen <workload spec> <JobQueue file name> [--format=text|binary]\n";
+        cout << "       sweep <JobQueue file name> [--quanta=q,q,...] [--max-jobs=n,n,...] [--io-time=t,t,...] [--threads=n]\n";
+        cout << "                  [--overhead=<spec>] [--levels=n]\n";
+        cout << "       tune <JobQueue file name> [--objective=wait|p99-wait|turnaround|p99-turnaround|throughput]\n";
+        cout << "                  [--quanta=low:high|q,q,...] [--max-jobs=n] [--io-time=t] [--threads=n] [--overhead=<spec>]\n";
+        cout << "                  [--arrivals]\n";
+        return -1;
+    }
 
-        // If all jobs in memory are waiting for IO
-        if(!myCPU.readyJobs()){
-            myCPU.incCPUTime();
-            continue;
+    // Run a grid of configurations over the same jobs in parallel and compare them in one table
+    else if(params[0] == "sweep"){
+        JobSource *JobQueue = openJobs(params[1]);
+        if(!JobQueue || JobQueue->endless()){
+            cout << (JobQueue ? "The sweep needs a finite number of jobs\n" : "Could not open " + params[1] + "\n");
+            delete JobQueue;
+            return -1;
         }
-
-        PCB currentJob = myCPU.getCurrentJob();
-        // Is this is first burst of CPU the job is receiving?
-        if(currentJob.getCurrentBurstNum() == 0){
-            myCPU.startJob();
-            myCPU.serviceJob();
+        // Read the jobs only once, every configuration reads the same copy
+        vector<int> trace;
+        readTrace(*JobQueue, trace);
+        bool malformed = JobQueue->malformed();
+        delete JobQueue;
+        if(malformed){
+            cout << "Malformed job in " << params[1] << "\n";
+            return -1;
         }
 
-        // If this burst cycle is complete
-        else if(currentJob.getCurrentBurstPC() == currentJob.getThisBurst()){
-
-            // Was this the last burst cycle? If yes, the process is complete
-            if(currentJob.getCurrentBurstNum() == currentJob.getNumBursts())
-                myStats.addStats(myCPU.completeJob());  // Complete job and record stats for summary at end of simulation
+        vector<sweepConfig> grid = sweepGrid(parseList(options.count("quanta") ? options["quanta"] : "5,10,20,50,100"),
+                                             parseList(options.count("max-jobs") ? options["max-jobs"] : "10"),
+                                             parseList(options.count("io-time") ? options["io-time"] : "10"),
+                                             options.count("levels") ? atoi(options["levels"].c_str()) : MLFQ_LEVELS);
+        bool sweepEventDriven = options["engine"] != "tick";    // The sweep uses the event driven engine by default
+        vector<sweepResult> results = runSweep(trace, grid, atoi(options["threads"].c_str()), sweepEventDriven,
+                                             overhead);
+        printSweepTable(grid, results);
+        return 0;
+    }
 
-            // The process is blocking for IO
-            else{
-                myCPU.insertToIOBlock(currentJob);
-            }
-            continue;
+    // Search for the best RR time quantum for an objective, trying quanta in parallel and abandoning hopeless ones early
+    else if(params[0] == "tune"){
+        int objective = parseObjective(options.count("objective") ? options["objective"] : "wait");
+        int memory = options.count("max-jobs") ? atoi(options["max-jobs"].c_str()) : MAX_JOBS;
+        int io = options.count("io-time") ? atoi(options["io-time"].c_str()) : IO_TIME;
+        string range = options.count("quanta") ? options["quanta"] : "1:1000";
+        if(params.size() != 2 || objective < 0 || memory <= 0 || io <= 0){
+            cout << "Invalid parameters for tuning\n";
+            return -1;
+        }
+        JobSource *JobQueue = openJobs(params[1]);
+        if(!JobQueue || JobQueue->endless()){
+            cout << (JobQueue ? "Tuning needs a finite number of jobs\n" : "Could not open " + params[1] + "\n");
+            delete JobQueue;
+            return -1;
+        }
+        vector<int> trace;
+        readTrace(*JobQueue, trace);
+        bool malformed = JobQueue->malformed();
+        delete JobQueue;
+        if(malformed){
+            cout << "Malformed job in " << params[1] << "\n";
+            return -1;
         }
-        // This burst cycle isn't complete, so continue processing it
-        else
-            myCPU.serviceJob();
-
-        // Increment CPU clock by 1 and check if any jobs finished IO
-        myCPU.incCPUTime();
 
-        // Print state of CPU every 200 units of time
-        if(myCPU.getCPUTime()%200 == 0 && myCPU.getCPUTime())
-            myCPU.printCPUState();
+        // Search a range (low:high), or try every quantum of a list
+        QuantumTuner tuner(trace, objective, memory, io, overhead, options["engine"] != "tick");
+        tuner.setAdmitOnArrival(admitOnArrival);
+        int threads = atoi(options["threads"].c_str());
+        size_t colon = range.find(':');
+        vector<long> quanta = parseList(range);
+        int best = colon == string::npos ? tuner.tune(vector<int>(quanta.begin(), quanta.end()), threads)
+                                         : tuner.tune(atoi(range.substr(0, colon).c_str()), atoi(range.substr(colon + 1).c_str()), threads);
+        if(!best){
+            cout << "Invalid quanta or no jobs to tune with\n";
+            return -1;
+        }
+        tuner.printCurve();
+        return 0;
     }
 
-    // Print summary statistics of simulation
-    cout << "FCFS\n";
-    cout << "CPU clock value = " << myCPU.getCPUTime() << endl;
-    myStats.printStats();
-}
-
-/**
- * SJF - Simulates a Shortest Job First algorithm in a virtual single processor CPU
- * @param: JobQ - contains a queue of strings describing a job
-           Format of each job in JobQ:
-                <ID> <ArrivalTime> <NumberOfBursts> <n numbers denoting length of each burst>
- * Prints CPU stats every 200 units of CPU time and summary stats at the end of simulation
-*/
-void SJF(queue<string> JobQ){
-    CPU myCPU;                          // Create virtual CPU (check CPU.h for implementation)
-    stats myStats;                      // Create an object to hold the run time statistics
-
-    // We need to run the CPU as long as there are pending jobs in the queue or memory
-    while(myCPU.memoryUsed() || JobQ.size()){
-        // Insert jobs into the ready queue if memory permits
-        while(myCPU.insertToReady(&JobQ));
-
-        // If all jobs in memory are waiting for IO
-        if(!myCPU.readyJobs()){
-            myCPU.incCPUTime();
-            continue;
+    // Generate a synthetic workload and write it to a job file
+    else if(params[0] == "gen"){
+        WorkloadGenerator gen;
+        if(params.size() != 3 || !gen.setSpec(params[1]) || gen.endless()){
+            cout << "Invalid workload spec\n";
+            return -1;
         }
-
-        // If a job has finished running, find the next shortest job and execute it
-        if(myCPU.getCurrentJob().getState() == STATE_READY)
-            myCPU.sortReadyQ();
-
-        PCB currentJob = myCPU.getCurrentJob();
-        // Is this is first burst of CPU the job is receiving?
-        if(currentJob.getCurrentBurstNum() == 0){
-            myCPU.startJob();
-            myCPU.serviceJob();
+        long written = binaryFormat ? convertTrace(gen, params[2]) : writeTextTrace(gen, params[2]);
+        if(written < 0){
+            cout << "Could not write " << params[2] << "\n";
+            return -1;
         }
+        cout << "Generated " << written << " jobs\n";
+        return 0;
+    }
 
-        // If this burst cycle is complete
-        else if(currentJob.getCurrentBurstPC() == currentJob.getThisBurst()){
-
-            // Was this the last burst cycle? If yes, the process is complete
-            if(currentJob.getCurrentBurstNum() == currentJob.getNumBursts())
-                myStats.addStats(myCPU.completeJob()); // Complete job and record stats for summary at end of simulation
-
-            // The process is blocking for IO
-            else
-                myCPU.insertToIOBlock(currentJob);
-
-            continue;
+    // Convert a text job file into the binary format, which the simulator can read without parsing
+    else if(params[0] == "convert"){
+        TextJobSource textJobs;
+        if(params.size() != 3 || !textJobs.open(params[1])){
+            cout << "Could not open job file\n";
+            return -1;
         }
-        // This burst cycle isn't complete, so continue processing it
-        else
-            myCPU.serviceJob();
-
-        myCPU.incCPUTime();
+        long converted = convertTrace(textJobs, params[2]);
+        if(converted < 0){
+            cout << "Could not write " << params[2] << "\n";
+            return -1;
+        }
+        if(textJobs.malformed()){
+            cout << "Malformed job in " << params[1] << "\n";
+            return -1;
+        }
+        cout << "Converted " << converted << " jobs\n";
+        return 0;
     }
 
-    cout << "SJF:\n";
-    cout << "CPU clock value = " << myCPU.getCPUTime() << endl;
-    myStats.printStats();
-}
+    // Round robin scheduling requires an extra parameter (time quantum), and so do MLFQ (quanta) and PRIO (aging interval)
+    else if(params.size() == 3){
+        algorithm = params[0];
+        filename = params[2];
+        qText = params[1];
+        q = atoi(qText.c_str());
+    }
+    // FCFS, SJF or SRTF
+    else{
+        algorithm = params[0];
+        filename = params[1];
+    }
 
-/**
- * RR - Simulates a Round robin preemption on FCFS algorithm in a virtual single processor CPU
- * @param: JobQ - contains a queue of strings describing a job
-           Format of each job in JobQ:
-                <ID> <ArrivalTime> <NumberOfBursts> <n numbers denoting length of each burst>
+    // Source of all the jobs, text or binary (jobs are read from it as they are loaded into memory)
+    JobSource *JobQueue = openJobs(filename);
+    if(!JobQueue){
+        cout << "Could not open " << filename << "\n";
+        return -1;
+    }
 
-           quantum - positive integer value specifying the time quantum for round robin preemption
- * Prints CPU stats every 200 units of CPU time and summary stats at the end of simulation
-*/
-void RR(queue<string> JobQ, int quantum){
-    CPU myCPU;                          // Create virtual CPU (check CPU.h for implementation)
-    stats myStats;                      // Create an object to hold the run time statistics
+    // Record one row per completed job in a results file if one is given (check ResultsWriter.h)
+    ResultsWriter results;
+    if(options.count("results")
+       && !results.open(options["results"], options["results-format"] == "binary" ? RESULTS_BINARY : RESULTS_CSV)){
+        cout << "Could not write " << options["results"] << "\n";
+        delete JobQueue;
+        return -1;
+    }
+    ResultsWriter *resultsOut = options.count("results") ? &results : NULL;
+
+    // IO devices, one per service time in --io-time (or --io-devices of them with the same service time) (check IOSubsystem.h)
+    // By default there is one device on a single core CPU and one per core on a multi-core CPU
+    bool configureIO = options.count("io-devices") || options.count("io-time");
+    vector<long> ioTimes = options.count("io-time") ? parseList(options["io-time"]) : vector<long>(1, IO_TIME);
+    int nDevices = options.count("io-devices") ? atoi(options["io-devices"].c_str())
+                   : ioTimes.size() == 1 && options.count("cores") ? atoi(options["cores"].c_str()) : ioTimes.size();
+    if(ioTimes.size() == 1 && nDevices > 0)
+        ioTimes.resize(nDevices, ioTimes[0]);
+    if(nDevices <= 0 || (int)ioTimes.size() != nDevices || *min_element(ioTimes.begin(), ioTimes.end()) <= 0){
+        cout << "Invalid IO devices\n";
+        delete JobQueue;
+        return -1;
+    }
 
+    // Simulate the algorithm on a CPU with several cores, each with its own ready queue (check MultiCore.h)
+    if(options.count("cores")){
+        int nCores = atoi(options["cores"].c_str());
+        int memory = options.count("max-jobs") ? atoi(options["max-jobs"].c_str()) : MAX_JOBS*nCores;
+        if(nCores <= 0 || memory <= 0 || (algorithm != "FCFS" && algorithm != "SJF" && algorithm != "RR") ||
+           options.count("save") || options.count("resume") || options.count("samples") || options.count("trace") ||
+           options.count("pipeline") || options.count("overhead") || options.count("nodes")){
+            cout << "Invalid parameters for a multi-core CPU\n";
+            delete JobQueue;
+            return -1;
+        }
+        if(algorithm == "RR" && q <= 0){
+            cout << "Invalid time quantum!";
+            delete JobQueue;
+            return -1;
+        }
 
-    if(!myCPU.writeQuantum(quantum)){   // Time quantum must be a positive integer
-        cout << "Invalid time quantum!";
-        return;
+        MultiCoreCPU myCPU(nCores, memory, IO_TIME, algorithm == "SJF" ? ORDER_SHORTEST : ORDER_FIFO,
+                           algorithm == "RR" ? q : INT_MAX);
+        myCPU.setResults(resultsOut);
+        myCPU.setAdmitOnArrival(admitOnArrival);
+        myCPU.setStopTime(stopTime);
+        if(configureIO)
+            myCPU.getIO().configure(ioTimes);
+        myCPU.run(JobQueue);
+        cout << algorithm << " on " << nCores << " cores\n";
+        cout << "CPU clock value = " << myCPU.getCPUTime() << endl;
+        myCPU.getStats().printStats();
+        myCPU.printCoreStats();
+        if(configureIO)
+            myCPU.getIO().printIOStats(myCPU.getCPUTime());
     }
 
-    // We need to run the CPU as long as there are pending jobs in the queue or memory
-    while(myCPU.memoryUsed() || JobQ.size()){
-        // Insert jobs into the ready queue if memory permits
-        while(myCPU.insertToReady(&JobQ));
+    // Simulate the algorithm on a fleet of CPUs, each with its own memory, queues and IO devices, behind a dispatcher (check Cluster.h)
+    else if(options.count("nodes")){
+        int nNodes = atoi(options["nodes"].c_str());
+        int memory = options.count("max-jobs") ? atoi(options["max-jobs"].c_str()) : MAX_JOBS;    // Per node
+        int dispatcher = options.count("dispatcher") ? parseDispatcher(options["dispatcher"]) : DISPATCH_P2C;
+        unsigned long window = options.count("window") ? strtoul(options["window"].c_str(), NULL, 10) : CLUSTER_WINDOW;
+        if(nNodes <= 0 || memory <= 0 || dispatcher < 0 || window == 0 || options.count("results") ||
+           options.count("save") || options.count("resume") || options.count("samples") || options.count("trace") ||
+           options.count("pipeline")){
+            cout << "Invalid parameters for a cluster\n";
+            delete JobQueue;
+            return -1;
+        }
 
-        // If all jobs in memory are waiting for IO
-        if(!myCPU.readyJobs()){
-            myCPU.incCPUTime();
-            continue;
+        Cluster fleet(nNodes, memory, IO_TIME, dispatcher, window, eventDriven);
+        fleet.setStopTime(stopTime);
+        fleet.setOverhead(overhead);
+        if(configureIO)
+            fleet.configureIO(ioTimes);
+        int threads = atoi(options["threads"].c_str());
+
+        bool simulated = false;
+        if(algorithm == "FCFS")
+            simulated = simulateCluster(*JobQueue, FCFSPolicy(), fleet, threads);
+        else if(algorithm == "SJF")
+            simulated = simulateCluster(*JobQueue, SJFPolicy(), fleet, threads);
+        else if(algorithm == "SRTF")
+            simulated = simulateCluster(*JobQueue, SRTFPolicy(), fleet, threads);
+        else if(algorithm == "RR")
+            simulated = simulateCluster(*JobQueue, RRPolicy(q), fleet, threads);
+        else if(algorithm == "MLFQ")
+            simulated = simulateCluster(*JobQueue, MLFQPolicy(parseLevelQuanta(qText, levels)), fleet, threads);
+        else if(algorithm == "PRIO")
+            simulated = simulateCluster(*JobQueue, PriorityPolicy(q, options.count("priorities") ? atoi(options["priorities"].c_str())
+                                                                                                : PRIORITY_LEVELS), fleet, threads);
+        else
+            cout << "Invalid algorithm name. Available options: FCFS, SJF, SRTF, RR, MLFQ, PRIO";
+        if(simulated)
+            fleet.printNodeStats();
+        if(simulated && options.count("node-stats") && !fleet.writeNodeStats(options["node-stats"])){
+            cout << "Could not write " << options["node-stats"] << "\n";
+            delete JobQueue;
+            return -1;
         }
+    }
 
-        PCB currentJob = myCPU.getCurrentJob();
-        // Is this is first burst of CPU the job is receiving?
-        if(currentJob.getCurrentBurstNum() == 0){
-            myCPU.startJob();
-            myCPU.serviceJob();
+    // Call functions based on algorithm selected
+    else{
+        // Number of jobs that fit in memory at a time
+        int memory = options.count("max-jobs") ? atoi(options["max-jobs"].c_str()) : MAX_JOBS;
+        if(memory <= 0){
+            cout << "Invalid number of jobs in memory\n";
+            delete JobQueue;
+            return -1;
+        }
+        CPU myCPU(memory);              // Create virtual CPU (check CPU.h for implementation)
+        myCPU.setVerbose(!quiet);
+        myCPU.setResults(resultsOut);
+        myCPU.setAdmitOnArrival(admitOnArrival);
+        myCPU.setStopTime(stopTime);
+        myCPU.getOverhead() = overhead;
+        if(configureIO)
+            myCPU.getIO().configure(ioTimes);
+        stats myStats;                  // Statistics of the jobs completed (restored along with the CPU when resuming)
+
+        // The parser of a pipeline reads ahead of the simulation, so the job file can't be saved where the simulation stopped
+        bool pipelined = options.count("pipeline") > 0;
+        if(pipelined && options.count("save")){
+            cout << "A pipelined simulation can't be saved\n";
+            delete JobQueue;
+            return -1;
         }
-        else if(currentJob.getCurrentBurstPC() == currentJob.getThisBurst()){
 
-            // Was this the last burst cycle? If yes, the process is complete
-            if(currentJob.getCurrentBurstNum() == currentJob.getNumBursts())
-                myStats.addStats(myCPU.completeJob());      // Complete job and record stats for summary at end of simulation
+        // Continue from a snapshot: the clock, jobs, queues, IO devices and statistics are those saved in it
+        if(options.count("resume") && !myCPU.loadSnapshot(options["resume"], myStats, *JobQueue)){
+            cout << "Could not resume from " << options["resume"] << " with " << filename << "\n";
+            delete JobQueue;
+            return -1;
+        }
 
-            // The process is blocking for IO
-            else{
-                myCPU.insertToIOBlock(currentJob);
+        // Record the state of the CPU every sample interval (the buffer is only allocated if samples are asked for)
+        size_t capacity = options.count("sample-capacity") ? strtoul(options["sample-capacity"].c_str(), NULL, 10) : SAMPLE_CAPACITY;
+        Sampler sampler(options.count("sample-interval") ? strtoul(options["sample-interval"].c_str(), NULL, 10) : SAMPLE_INTERVAL,
+                        options.count("samples") ? capacity : 1);
+        if(options.count("samples"))
+            myCPU.setSampler(&sampler);
+
+        // Write the schedule as a trace while simulating
+        TraceWriter trace;
+        if(options.count("trace")){
+            if(!trace.open(options["trace"])){
+                cout << "Could not create " << options["trace"] << "\n";
+                delete JobQueue;
+                return -1;
             }
-            continue;
+            myCPU.setTrace(&trace);
         }
 
-        // If the time quantum expired, preempt this job, add it to the end of the ready queue
-        else if(currentJob.getCurrentQuantumTime() == myCPU.getQuantum()){
-            myCPU.preemptJob();
-            continue;
-        }
+        bool simulated = false;
+        if(algorithm == "FCFS")
+            simulated = simulate(*JobQueue, FCFSPolicy(), myCPU, myStats, eventDriven, pipelined);
+        else if(algorithm == "SJF")
+            simulated = simulate(*JobQueue, SJFPolicy(), myCPU, myStats, eventDriven, pipelined);
+        else if(algorithm == "SRTF")
+            simulated = simulate(*JobQueue, SRTFPolicy(), myCPU, myStats, eventDriven, pipelined);
+        else if(algorithm == "RR")
+            simulated = simulate(*JobQueue, RRPolicy(q), myCPU, myStats, eventDriven, pipelined);     // Note : the RR policy will take care of invalid time quantum
+        else if(algorithm == "MLFQ")
+            simulated = simulate(*JobQueue, MLFQPolicy(parseLevelQuanta(qText, levels)), myCPU, myStats, eventDriven, pipelined);
+        else if(algorithm == "PRIO")
+            simulated = simulate(*JobQueue, PriorityPolicy(q, options.count("priorities") ? atoi(options["priorities"].c_str())
+                                                                                         : PRIORITY_LEVELS), myCPU, myStats, eventDriven, pipelined);
         else
-            myCPU.serviceJob();
+            cout << "Invalid algorithm name. Available options: FCFS, SJF, SRTF, RR, MLFQ, PRIO";
+        if(simulated && configureIO)
+            myCPU.getIO().printIOStats(myCPU.getCPUTime());
+        if(simulated && overhead.any())
+            myCPU.printOverheadStats();
+
+        if(!trace.close()){
+            cout << "Could not write " << options["trace"] << "\n";
+            delete JobQueue;
+            return -1;
+        }
+        if(simulated && options.count("samples") &&
+           !sampler.write(options["samples"], options["samples-format"] == "binary" ? RESULTS_BINARY : RESULTS_CSV)){
+            cout << "Could not write " << options["samples"] << "\n";
+            delete JobQueue;
+            return -1;
+        }
 
-        // Increment CPU clock by 1 and check if any jobs finished IO
-        myCPU.incCPUTime();
+        // Save where the simulation stopped, so it can be resumed later
+        if(simulated && options.count("save") && !myCPU.saveSnapshot(options["save"], myStats, *JobQueue)){
+            cout << "Could not save a snapshot to " << options["save"] << "\n";
+            delete JobQueue;
+            return -1;
+        }
     }
 
-    cout << "RR\n";
-    cout << "CPU clock value = " << myCPU.getCPUTime() << endl;
-    myStats.printStats();
+    // Reading stops at a malformed job (e.g. one without bursts), so the jobs after it were never simulated
+    if(JobQueue->malformed()){
+        cout << "Malformed job in " << filename << "\n";
+        delete JobQueue;
+        return -1;
+    }
+    delete JobQueue;
+    if(!results.close()){
+        cout << "Could not write " << options["results"] << "\n";
+        return -1;
+    }
+    return 0;
 }
-
-
@@ -2,27 +2,42 @@
  * Author : Prahar Ijner
  * This file contains the stats class used to store the summary statistics during CPU scheduling simulation
  *
+ * A stats object made from one job's values only holds those values. Once stats are added together, every metric is
+ * also counted in a histogram (look at Histogram.h), so percentiles of the waiting time, turn around time and shots
+ * can be printed along with the averages.
+ *
+ * Requires Histogram.h
  */
 
 #ifndef STATS_H_INCLUDED
 #define STATS_H_INCLUDED
 
 #include<iostream>
+#include "Histogram.h"
 
 using namespace std;
 
 class stats{
 private:
-    int pTime, wTime, taTime, shots, n;
+    long pTime, wTime, taTime, shots, n;
+    Histogram pHist, wHist, taHist, shotsHist;
+    void printPercentiles(ostream &out, const char *name, Histogram &h);
 public:
     stats();
-    stats(int processingTime, int waitTime, int turnAroundTime, int shotsUsed);
-    int getPTime()  { return pTime; }           // Read the processing time
-    int getwTime()  { return wTime; }           // Read the waiting time
-    int gettaTime() { return taTime; }          // Read the turn around time
-    int getShots()  { return shots; }           // Read the number of shots used
-    void addStats(stats);
-    void printStats();
+    stats(long processingTime, long waitTime, long turnAroundTime, long shotsUsed);
+    long getPTime()  { return pTime; }          // Read the processing time
+    long getwTime()  { return wTime; }          // Read the waiting time
+    long gettaTime() { return taTime; }         // Read the turn around time
+    long getShots()  { return shots; }          // Read the number of shots used
+    long getCount()  { return n; }              // Read the number of jobs the statistics are for
+    Histogram &getPTimeHist()   { return pHist; }       // Read the distribution of the processing time
+    Histogram &getwTimeHist()   { return wHist; }       // Read the distribution of the waiting time
+    Histogram &gettaTimeHist()  { return taHist; }      // Read the distribution of the turn around time
+    Histogram &getShotsHist()   { return shotsHist; }   // Read the distribution of the number of shots used
+    void addStats(const stats &s);
+    void printStats(ostream &out = cout);
+    void save(SnapshotWriter &out);
+    bool load(SnapshotReader &in);
 };
 
 // Default constructor
@@ -35,7 +50,7 @@ stats::stats(){
 }
 
 // Overloaded constructor to initialize based on input values
-stats::stats(int processingTime, int waitTime, int turnAroundTime, int shotsUsed){
+stats::stats(long processingTime, long waitTime, long turnAroundTime, long shotsUsed){
     pTime = processingTime;
     wTime = waitTime;
     taTime = turnAroundTime;
@@ -43,22 +58,57 @@ stats::stats(int processingTime, int waitTime, int turnAroundTime, int shotsUsed
     n = 1;
 }
 
-// Function to add the processing time, waiting time, turn around time, and number of shots used of this object and another
-void stats::addStats(stats s){
-    pTime += s.getPTime();
-    wTime += s.getwTime();
-    taTime += s.gettaTime();
-    shots += s.getShots();
-    n++;
+/* Function to add the processing time, waiting time, turn around time, and number of shots used of this object and another
+ * The other object is either one job's stats, whose values are counted in the histograms, or stats already added
+ * together (e.g. from another run), whose histograms are merged into these
+ */
+void stats::addStats(const stats &s){
+    pTime += s.pTime;
+    wTime += s.wTime;
+    taTime += s.taTime;
+    shots += s.shots;
+    if(s.wHist.getCount() == 0 && s.n == 1){
+        pHist.record(s.pTime);
+        wHist.record(s.wTime);
+        taHist.record(s.taTime);
+        shotsHist.record(s.shots);
+    }
+    else{
+        pHist.merge(s.pHist);
+        wHist.merge(s.wHist);
+        taHist.merge(s.taHist);
+        shotsHist.merge(s.shotsHist);
+    }
+    n += s.n;
+}
+
+// Function to print the tail percentiles and the maximum of one metric
+void stats::printPercentiles(ostream &out, const char *name, Histogram &h){
+    out << name << " p50 = " << h.percentile(50) << ", p90 = " << h.percentile(90) << ", p99 = " << h.percentile(99)
+        << ", p99.9 = " << h.percentile(99.9) << ", max = " << h.getMax() << endl;
 }
 
-// Function to print the average of all statistics collected (used at the end of simulation)
-void stats::printStats(){
-    cout << "Average processing time = " << ((float)pTime)/n << endl;
-    cout << "Average waiting time = " << ((float)wTime)/n << endl;
-    cout << "Average turn around time = " << ((float)taTime)/n << endl;
-    cout << "Average shots used = " << ((float)shots)/n << endl;
+// Function to print the average of all statistics collected and the percentiles of the waiting time, turn around time and shots (used at the end of simulation)
+void stats::printStats(ostream &out){
+    out << "Average processing time = " << ((double)pTime)/n << endl;
+    out << "Average waiting time = " << ((double)wTime)/n << endl;
+    out << "Average turn around time = " << ((double)taTime)/n << endl;
+    out << "Average shots used = " << ((double)shots)/n << endl;
+    printPercentiles(out, "Waiting time", wHist);
+    printPercentiles(out, "Turn around time", taHist);
+    printPercentiles(out, "Shots used", shotsHist);
 }
 
+// Function to write the statistics collected so far to a snapshot
+void stats::save(SnapshotWriter &out){
+    out.put(pTime); out.put(wTime); out.put(taTime); out.put(shots); out.put(n);
+    pHist.save(out); wHist.save(out); taHist.save(out); shotsHist.save(out);
+}
+
+// Function to read the statistics back from a snapshot. Returns false if the snapshot ended
+bool stats::load(SnapshotReader &in){
+    in.get(pTime); in.get(wTime); in.get(taTime); in.get(shots); in.get(n);
+    return pHist.load(in) && wHist.load(in) && taHist.load(in) && shotsHist.load(in);
+}
 
 #endif // STATS_H_INCLUDED
@@ -0,0 +1,276 @@
+//***************************************************************************************
+// Differential validation of the simulation engines against the reference implementation
+// @params: [--runs=<n>] [--seed=<s>] [--jobs=<n>] [--policies=FCFS,SJF,RR]
+//
+// Runs FCFS, SJF and RR over generated workloads with random configurations (policy, time quantum, number of jobs that
+// fit in memory, IO time and workload spec) on the reference implementation (the original tick by tick loops, check
+// Reference.h), on the tick engine and on the event engine. The results of every job (in the order the jobs complete),
+// the CPU clock and the summary statistics must be exactly the same. One line is printed per run:
+//      run <n>: <policy> q=<q> memory=<m> io=<t> <workload spec> resumed at <t> as <policy> q=<q> ok|DIVERGED
+//               reference=<s> tick=<s> (<x>x) event=<s> (<x>x)
+// where x is how many times faster than the reference each engine ran. For a run that diverged, the first job whose
+// results differ (or the first difference in the clock or statistics) is printed under it.
+// Every run is also stopped at a random time, saved to a snapshot and resumed, on both engines: resumed with the same
+// policy it must give the results of the reference, and resumed as another policy (any of FCFS, SJF, SRTF, RR, MLFQ and
+// PRIO, drawn for the line) it must complete every job, with the same results on both engines.
+// The same seed always generates the same runs. Exits with -1 if any run diverged.
+// Required files to run: CPU.h, stats.h, PCB.h, policy.h, scheduler.h, ReadyQueue.h, JobSource.h, Workload.h, Sweep.h,
+//                        Histogram.h, Sampler.h, TraceWriter.h, Pipeline.h, SPSCRing.h, Overhead.h, Reference.h
+//***************************************************************************************
+
+#include <chrono>
+#include <cstdio>
+#include <unistd.h>
+#include "CPU.h"
+#include "Workload.h"
+#include "policy.h"
+#include "scheduler.h"
+#include "Sweep.h"
+#include "Reference.h"
+
+using namespace std;
+
+// Results of one run of an engine
+struct engineRun{
+    vector<jobResult> completed;    // Results of every job, in the order the jobs completed
+    unsigned long clock;
+    long pTime, wTime, taTime, shots, n;
+    double seconds;
+};
+
+// Function to read the time in seconds from an arbitrary starting point
+double now(){
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Function to draw an integer from low to high
+long draw(Random &rng, long low, long high){
+    return low + (long)(rng.next() % (unsigned long long)(high - low + 1));
+}
+
+// Function to run the reference implementation over a workload already loaded into memory
+engineRun runReference(string policy, long quantum, long memory, long ioTime, vector<int> &trace){
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    engineRun r;
+    double start = now();
+    r.clock = referenceRun(policy, quantum, JobQ, memory, ioTime, r.completed);
+    r.seconds = now() - start;
+
+    // The reference implementation doesn't keep statistics, so they are added up from the results of the jobs
+    r.pTime = r.wTime = r.taTime = r.shots = 0;
+    r.n = r.completed.size();
+    for(size_t i=0; i<r.completed.size(); i++){
+        r.pTime += r.completed[i].processing;
+        r.wTime += r.completed[i].wait;
+        r.taTime += r.completed[i].turnaround;
+        r.shots += r.completed[i].shots;
+    }
+    return r;
+}
+
+// Function to run the tick or event engine over a workload already loaded into memory
+engineRun runEngine(string policy, long quantum, long memory, long ioTime, vector<int> &trace, bool eventDriven){
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    CPU myCPU(memory, ioTime);
+    stats myStats;
+    engineRun r;
+    myCPU.setVerbose(false);
+    myCPU.setCompletions(&r.completed);
+    double start = now();
+    runPolicy(policy, quantum, JobQ, myCPU, myStats, eventDriven);
+    r.seconds = now() - start;
+    r.clock = myCPU.getCPUTime();
+    r.pTime = myStats.getPTime();
+    r.wTime = myStats.getwTime();
+    r.taTime = myStats.gettaTime();
+    r.shots = myStats.getShots();
+    r.n = myStats.getCount();
+    return r;
+}
+
+/* Function to run the tick or event engine over a workload until the stop time, save a snapshot there, and continue
+ * from the snapshot with another policy (or the same one) on a new CPU. The results cover both parts of the run
+ */
+engineRun runResumed(string policy, long quantum, long memory, long ioTime, vector<int> &trace, bool eventDriven,
+                     unsigned long stop, string resumePolicy, long resumeQuantum, string snapshot){
+    engineRun r;
+    BinaryJobSource firstQ(trace.data(), trace.data() + trace.size());
+    CPU first(memory, ioTime);
+    stats firstStats;
+    first.setVerbose(false);
+    first.setCompletions(&r.completed);
+    first.setStopTime(stop);
+    runPolicy(policy, quantum, firstQ, first, firstStats, eventDriven);
+    first.saveSnapshot(snapshot, firstStats, firstQ);
+
+    BinaryJobSource JobQ(trace.data(), trace.data() + trace.size());
+    CPU myCPU(memory, ioTime);
+    stats myStats;              // The statistics of the first part are restored along with the CPU
+    myCPU.setVerbose(false);
+    myCPU.setCompletions(&r.completed);
+    double start = now();
+    if(myCPU.loadSnapshot(snapshot, myStats, JobQ))
+        runPolicy(resumePolicy, resumeQuantum, JobQ, myCPU, myStats, eventDriven);
+    r.seconds = now() - start;
+    r.clock = myCPU.getCPUTime();
+    r.pTime = myStats.getPTime();
+    r.wTime = myStats.getwTime();
+    r.taTime = myStats.gettaTime();
+    r.shots = myStats.getShots();
+    r.n = myStats.getCount();
+    return r;
+}
+
+// Function to write the results of a job
+void printJob(ostream &out, const char *engine, const jobResult &j){
+    out << "    " << engine << ": id=" << j.id << " end=" << j.end << " processing=" << j.processing << " wait=" << j.wait
+        << " turnaround=" << j.turnaround << " shots=" << j.shots << "\n";
+}
+
+/* Function to compare the results of an engine with those of the reference (or another engine) and write the first
+ * difference to out. The start times are not compared, as the reference implementation never records them
+ * Returns false if the results differ
+ */
+bool compareRuns(ostream &out, const char *engine, engineRun &ref, engineRun &run, const char *reference = "reference"){
+    size_t n = min(ref.completed.size(), run.completed.size());
+    for(size_t i=0; i<n; i++){
+        jobResult &a = ref.completed[i], &b = run.completed[i];
+        if(a.id != b.id || a.end != b.end || a.processing != b.processing || a.wait != b.wait ||
+           a.turnaround != b.turnaround || a.shots != b.shots){
+            out << "  " << engine << ": first divergent job is completion " << i + 1 << "\n";
+            printJob(out, reference, a);
+            printJob(out, engine, b);
+            return false;
+        }
+    }
+    if(ref.completed.size() != run.completed.size()){
+        out << "  " << engine << ": " << run.completed.size() << " jobs completed, the " << reference << " completed "
+            << ref.completed.size() << "\n";
+        return false;
+    }
+    if(ref.clock != run.clock){
+        out << "  " << engine << ": CPU clock " << run.clock << ", the " << reference << " ended at " << ref.clock << "\n";
+        return false;
+    }
+    if(ref.pTime != run.pTime || ref.wTime != run.wTime || ref.taTime != run.taTime || ref.shots != run.shots ||
+       ref.n != run.n){
+        out << "  " << engine << ": statistics (jobs, processing, wait, turn around, shots) " << run.n << " " << run.pTime
+            << " " << run.wTime << " " << run.taTime << " " << run.shots << ", the " << reference << " has " << ref.n << " "
+            << ref.pTime << " " << ref.wTime << " " << ref.taTime << " " << ref.shots << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    long runs = 100, maxJobs = 2000;
+    unsigned long long seed = 1;
+    vector<string> policies;
+    policies.push_back("FCFS");
+    policies.push_back("SJF");
+    policies.push_back("RR");
+
+    for(int i=1; i<argc; i++){
+        string arg(argv[i]);
+        if(arg.compare(0, 7, "--runs=") == 0)
+            runs = atol(arg.substr(7).c_str());
+        else if(arg.compare(0, 7, "--seed=") == 0)
+            seed = strtoull(arg.substr(7).c_str(), NULL, 10);
+        else if(arg.compare(0, 7, "--jobs=") == 0)
+            maxJobs = atol(arg.substr(7).c_str());
+        else if(arg.compare(0, 11, "--policies=") == 0){
+            policies.clear();
+            istringstream names(arg.substr(11));
+            string name;
+            while(getline(names, name, ','))
+                policies.push_back(name);
+        }
+        else{
+            cout << "Usage: [--runs=<n>] [--seed=<s>] [--jobs=<n>] [--policies=FCFS,SJF,RR]\n";
+            return -1;
+        }
+    }
+    for(size_t i=0; i<policies.size(); i++)
+        if(policies[i] != "FCFS" && policies[i] != "SJF" && policies[i] != "RR"){
+            cout << "Only FCFS, SJF and RR have a reference implementation\n";
+            return -1;
+        }
+    if(runs <= 0 || maxJobs <= 0 || policies.empty()){
+        cout << "The number of runs and jobs must be positive\n";
+        return -1;
+    }
+
+    Random rng(seed);
+    Random resumeRng(seed + 1);     // Draws where to stop and how to resume, so the runs of a seed don't depend on it
+    const char *resumePolicies[] = { "FCFS", "SJF", "SRTF", "RR", "MLFQ", "PRIO" };
+    ostringstream snapshotName;
+    snapshotName << "/tmp/cpusim_validate_" << getpid() << ".snap";
+    string snapshot = snapshotName.str();
+    long diverged = 0;
+    double refTime = 0, tickTime = 0, eventTime = 0;
+    for(long run=1; run<=runs; run++){
+        // Draw a random configuration and workload. Short bursts from a small range make ties (e.g. in SJF) common
+        string policy = policies[draw(rng, 0, policies.size() - 1)];
+        long quantum = draw(rng, 1, 100);
+        long memory = draw(rng, 1, 50);
+        long ioTime = draw(rng, 1, 30);
+        const char *lengths[] = { "uniform:1:10", "uniform:1:250", "exp:50", "pareto:1.5:1" };
+        ostringstream spec;
+        spec << "gen:jobs=" << draw(rng, 1, maxJobs) << ",seed=" << rng.next() % 1000000 << ",bursts=uniform:1:"
+             << draw(rng, 1, 20) << ",length=" << lengths[draw(rng, 0, 3)] << ",arrival=exp:" << draw(rng, 0, 100);
+
+        WorkloadGenerator gen;
+        gen.setSpec(spec.str());
+        vector<int> trace;
+        long jobs = readTrace(gen, trace);
+
+        engineRun ref = runReference(policy, quantum, memory, ioTime, trace);
+        engineRun tick = runEngine(policy, quantum, memory, ioTime, trace, false);
+        engineRun event = runEngine(policy, quantum, memory, ioTime, trace, true);
+        refTime += ref.seconds;
+        tickTime += tick.seconds;
+        eventTime += event.seconds;
+
+        // Compare first, so the verdict is on the line of the run and the first differences are printed under it
+        ostringstream differences;
+        bool tickOk = compareRuns(differences, "tick", ref, tick);
+        bool eventOk = compareRuns(differences, "event", ref, event);
+
+        // Stop part way and resume, with the same policy and with another one
+        unsigned long stop = draw(resumeRng, 1, max(1L, (long)ref.clock - 1));
+        string otherPolicy = resumePolicies[draw(resumeRng, 0, 5)];
+        long otherQuantum = draw(resumeRng, 1, 100);
+        for(int e=0; e<2; e++){
+            engineRun same = runResumed(policy, quantum, memory, ioTime, trace, e, stop, policy, quantum, snapshot);
+            if(compareRuns(differences, e ? "event resumed" : "tick resumed", ref, same))
+                continue;
+            if(e)
+                eventOk = false;
+            else
+                tickOk = false;
+        }
+        engineRun tickOther = runResumed(policy, quantum, memory, ioTime, trace, false, stop, otherPolicy, otherQuantum, snapshot);
+        engineRun eventOther = runResumed(policy, quantum, memory, ioTime, trace, true, stop, otherPolicy, otherQuantum, snapshot);
+        if(tickOther.n != jobs){
+            differences << "  tick resumed as " << otherPolicy << ": " << tickOther.n << " of " << jobs << " jobs completed\n";
+            tickOk = false;
+        }
+        if(!compareRuns(differences, "event resumed", tickOther, eventOther, "tick resumed"))
+            eventOk = false;
+
+        if(!tickOk || !eventOk)
+            diverged++;
+        printf("run %ld: %s q=%ld memory=%ld io=%ld %s resumed at %lu as %s q=%ld %s reference=%.6f tick=%.6f (%.1fx) "
+               "event=%.6f (%.1fx)\n", run, policy.c_str(), quantum, memory, ioTime, spec.str().c_str(), stop,
+               otherPolicy.c_str(), otherQuantum, tickOk && eventOk ? "ok" : "DIVERGED", ref.seconds, tick.seconds,
+               ref.seconds/max(tick.seconds, 1e-9), event.seconds, ref.seconds/max(event.seconds, 1e-9));
+        fputs(differences.str().c_str(), stdout);
+        fflush(stdout);
+    }
+
+    remove(snapshot.c_str());
+    printf("%ld runs, %ld diverged. reference=%.6f tick=%.6f (%.1fx) event=%.6f (%.1fx)\n", runs, diverged, refTime, tickTime,
+           refTime/max(tickTime, 1e-9), eventTime, refTime/max(eventTime, 1e-9));
+    return diverged ? -1 : 0;
+}